@@ -1,412 +1,795 @@
-#include <AFMotor.h>
-#include <string.h>
-#include <math.h>
-
-#define  STEPS_PER_REVOLUTION         200
-#define  HALF_STEPS_PER_REVOLUTION    (STEPS_PER_REVOLUTION * 2)
-
-#define  STEPS_AT_RESET_POSITION      (STEPS_PER_REVOLUTION * 3 / 4)      // 270 degrees.  vertical down position of vector.
-#define  HALF_STEPS_AT_RESET_POSITION (STEPS_AT_RESET_POSITION * 2)
-
-#define  NUM_HALF_STEPS_PER_DEGREE    (HALF_STEPS_PER_REVOLUTION / 360.0)
-#define  NUM_DEGREES_PER_HALF_STEP    (360.0 / HALF_STEPS_PER_REVOLUTION)
-
-#define  CMD_BUF_LEN                  10
-
-// Connect a stepper motor with 48 steps per revolution (7.5 degree)
-//   - to motor port #1 (M1 and M2)
-//   - to motor port #2 (M3 and M4)
-AF_Stepper motor(STEPS_PER_REVOLUTION, 1);
-
-int             rpm                   = 3;
-int             halfSteps             = HALF_STEPS_AT_RESET_POSITION;     // one and only variable that maintains position of the motor.
-unsigned char   cmdBuf[CMD_BUF_LEN];
-unsigned int    cmdBufIndex           = 0;
-bool            runMotor              = false;
-unsigned int    delayMs;
-unsigned char   stepType              = INTERLEAVE;
-int             targetHalfSteps        = -1;
-bool            isCounterClockwise    = true;
-bool            doHalfStep            = false;
-
-/*
- * Executed only once at bootup.
- */
-void setup()
-{
-  Serial.begin(115200);           // set up Serial library at 9600 bps
-  Serial.println("Rotating vector application ready");
-
-  calculate_delay_ms();
-}
-
-/*
- * 
- */
-void calculate_delay_ms()
-{
-  float ms_in_1_minute          = 1000.0 * 60;
-  float steps_per_revolution;
-  
-  if (stepType == INTERLEAVE) {
-    steps_per_revolution = HALF_STEPS_PER_REVOLUTION;
-  }
-  else {
-    // step type is SINGLE or DOUBLE
-    steps_per_revolution = STEPS_PER_REVOLUTION;
-  }
-
-  float one_rpm_delay_in_ms     = ms_in_1_minute / steps_per_revolution;
-  
-  delayMs                       = one_rpm_delay_in_ms / rpm;
-  
-}
-
-/*
- * 
- */
-void configure_motor_rpm(int rpm_to_set)
-{
-  rpm = rpm_to_set;
-  calculate_delay_ms();
-  
-  runMotor = true;
-  
-  Serial.print("Running motor at ");
-  Serial.print(rpm);
-  Serial.println(" rpm");
-}
-
-/*
- * Read commands from PC. Each command is a character followed by a new line. 
- * If there are more than one non-newline characters before a newline, each of them is interpreted as a command.
- */
-void ReadAndExecuteCommand()
-{
-  bool cmdReady = false;
-  unsigned char data;
-  
-  //---------------------------------------------------------------------------------
-  // Read a serial byte, if available.  Save to command buffer. Increment index.
-  // If received byte was new line, replace it with a null byte (string terminator).
-  // If more bytes received than allocated for, restart saving from beginning of buffer.
-  //---------------------------------------------------------------------------------
-  if (Serial.available())
-  {
-    data = Serial.read();
-    // Serial.println(data);
-
-    if (data == '\n')
-      data = 0;
-    
-    cmdBuf[cmdBufIndex++] = data;       // save data byte to buffer. increment index.
-    
-    if (data == 0) {
-      cmdReady = true;
-
-      // cmd will be handled before leaving this function.
-      // cmdBufIndex will be set to zero immediately after executing the command.
-    }
-    else {
-      if (cmdBufIndex >= CMD_BUF_LEN) {
-        cmdBufIndex = 0;    // discard everything we got so far and start over.
-      }
-    }
-  } // if Serial.available()
-
-  //------------------------------------------------
-  // If command is ready, handle it.
-  //------------------------------------------------
-  if (cmdReady)
-  {
-    // cmdBuf is guaranteed to be a null terminated string
-    
-    int cmdLen            = strlen((const char*)cmdBuf);
-    unsigned char cmdId;
-
-    // any new command invalidates the 'g' command if it was in progress.
-    targetHalfSteps = -1;
-
-    if (cmdLen > 0) {
-      cmdId = cmdBuf[0];
-      
-      switch (cmdId)
-      {
-        case '1':
-          configure_motor_rpm(3);
-          break;
-        case '2':
-          configure_motor_rpm(4);
-          break;
-        case '3':
-          configure_motor_rpm(5);
-          break;
-        case '4':
-          configure_motor_rpm(6);
-          break;
-        case '5':
-          configure_motor_rpm(10);
-          break;
-        case '6':
-          configure_motor_rpm(13);
-          break;
-
-        //------------------------------------------------------------------------
-        // go to a specific angle and stop.
-        //------------------------------------------------------------------------
-        case 'g':
-        {
-          float targetAngle = atof((const char*) (cmdBuf + 1));
-          // keep delayMs unchanged so that the speed at which this happens is the same.
-          targetHalfSteps = int(round(float(targetAngle * NUM_HALF_STEPS_PER_DEGREE)));
-
-          Serial.print("Going to ");
-          Serial.print(targetAngle);
-          Serial.print(" degrees.  targetHalfSteps = ");
-          Serial.println(targetHalfSteps);
-          
-          runMotor = true;     // run the motor in case we were paused.
-          break;
-        }
-
-        //------------------------------------------------------------------------
-        // select direction of vector rotation
-        //------------------------------------------------------------------------
-        case '<':
-          isCounterClockwise = true;
-          break;
-        case '>':
-          isCounterClockwise = false;
-          break;
-
-        //------------------------------------------------------------------------
-        // half step only
-        //------------------------------------------------------------------------
-        case 'h':
-          doHalfStep = true;
-          runMotor = true;
-
-          // if step type is not half step, it will be temporarily set to half step just before acutally stepping the motor.
-          break;
-
-        //------------------------------------------------------------------------
-        // calibrate current half step to the given angle in degrees
-        //------------------------------------------------------------------------
-        case '=':
-        {
-          int calibrationAngle = atoi((const char*) (cmdBuf + 1));
-          Serial.print("Calibrating current position to ");
-          Serial.print(calibrationAngle);
-          Serial.print(" degrees. ");
-          
-          halfSteps = int(round(calibrationAngle * NUM_HALF_STEPS_PER_DEGREE));
-          Serial.print("New nstep = ");
-          Serial.println(halfSteps >> 1);
-          break;
-        }
-        
-        //------------------------------------------------------------------------
-        // handle commands setting the mode of energizing the coils.
-        //------------------------------------------------------------------------
-        case 's':
-          stepType = SINGLE;
-          break;
-        case 'd':
-          stepType = DOUBLE;
-          break;
-        case 'i':
-          stepType = INTERLEAVE;
-          break;      
-        
-        //------------------------------------------------------------------------
-        // Reset 
-        //------------------------------------------------------------------------
-        case 'r':
-          halfSteps = HALF_STEPS_AT_RESET_POSITION;
-          motor.release();        // coils will be released. stick will fall to 270 degree position due to gravity.
-          runMotor = false;
-          Serial.println("Releasing motor coils.  Vector should fall to 270 degree position.");
-          break;
-        
-        //------------------------------------------------------------------------
-        // Pause the motor
-        //------------------------------------------------------------------------
-        case 'p':     
-          runMotor = false;
-          Serial.println("Pausing motor");
-          break;
-
-        //------------------------------------------------------------------------
-        // continue running a paused motor
-        //------------------------------------------------------------------------
-        case 'c':
-          runMotor = true;
-          Serial.println("Resuming motor at speed set earlier");
-          break;
-
-
-        //------------------------------------------------------------------------
-        // print internal variables for debug purpose
-        //------------------------------------------------------------------------
-        case '?':
-          Serial.print("rpm=");
-          Serial.print(rpm);
-          Serial.print(", halfSteps=");
-          Serial.print(halfSteps);
-          Serial.print(", runMotor=");
-          Serial.print(runMotor);
-          Serial.print(", delayMs=");
-          Serial.print(delayMs);
-          Serial.print(", stepType=");
-          Serial.print(stepType);
-          Serial.print(", targetHalfSteps=");
-          Serial.print(targetHalfSteps);
-          Serial.print(", isCounterClockwise=");
-          Serial.print(isCounterClockwise);
-          Serial.print(", doHalfStep=");
-          Serial.print(doHalfStep);
-          Serial.println();
-          
-          break;
-        
-        default:
-          // nothing to do
-          break;
-          
-      } // switch(cmdId)
-    } // if (cmdLen > 0)
-    
-    cmdReady = false;
-    cmdBufIndex = 0;
-  }
-}
-
-void loop()
-{
-  //----------------------------------------------
-  // Turn motor by 1 step followed by the set delay
-  //----------------------------------------------
-  if (runMotor)
-  {
-    // Possible values for 2nd argument to .onestep() are
-    //    - SINGLE - One coil is energized at a time.
-    //    - DOUBLE - Two coils are energized at a time for more torque.
-    //    - INTERLEAVE - Alternate between single and double to create a half-step in between.
-    //                   This can result in smoother operation, but because of the extra half-step, the speed is reduced by half too.
-    //    - MICROSTEP - Adjacent coils are ramped up and down to create a number of 'micro-steps' between each full step.
-    //                  This results in finer resolution and smoother rotation, but with a loss in torque.
-    //                  Abhir's note: microstepping does not work with motor.onestep()
-
-    char oldStepType;
-    
-    //-------------------------------------
-    // Backup step type if we are going to change it for single stepping.
-    //-------------------------------------
-    if (doHalfStep)
-    {
-      oldStepType = stepType;
-      stepType = INTERLEAVE;
-    }
-
-    //------------------------------------------------------------------
-    // Perform a single step in the set direction.
-    //------------------------------------------------------------------
-    if (isCounterClockwise)
-      motor.onestep(BACKWARD, stepType);
-     else
-      motor.onestep(FORWARD, stepType); 
-
-    
-    //------------------------------------------------------------------
-    // increment the step count. step count is stored in deci steps.    
-    //------------------------------------------------------------------
-    switch (stepType)
-    {
-      case SINGLE:
-      case DOUBLE:
-        if (isCounterClockwise)
-          halfSteps += 2;
-        else
-          halfSteps -= 2;
-        break;
-
-      case INTERLEAVE:
-        if (isCounterClockwise)
-          halfSteps++;
-        else
-          halfSteps--;
-        break;
-      
-    }
-
-    //-------------------------------------
-    // Restore ste type, in case it was temporarily changed for single stepping.
-    //-------------------------------------
-    if (doHalfStep)
-    {
-      stepType = oldStepType;
-    }
-    
-    //----------------------------------------------
-    // rebase to 0 if gone over a full revolution.
-    //----------------------------------------------
-    // for counterclockwise direction, deci steps will go over 200*10
-    if (isCounterClockwise)
-    {
-      if (halfSteps >= HALF_STEPS_PER_REVOLUTION)
-        halfSteps -= HALF_STEPS_PER_REVOLUTION;
-    }
-    else
-    {
-      // for clockwise direction, deci steps will be decremented, hence will go below zero.
-      if (halfSteps <= 0)
-        halfSteps += HALF_STEPS_PER_REVOLUTION;
-    }
-    
-    //----------------------------------------------
-    // If asked to advance by just 1 degree, pause the motor.
-    //----------------------------------------------
-    if (doHalfStep)
-    {
-      doHalfStep = false;     // we are done half stepping
-      runMotor = false;         // pause the motor
-    }
- 
-    //----------------------------------------------
-    // were we asked to go to a specific angle?  If yes, and if we reached that, stop.
-    //----------------------------------------------
-    if ((targetHalfSteps != -1) && (targetHalfSteps == halfSteps))
-    {
-      runMotor = false;
-      targetHalfSteps = -1;
-      
-      Serial.print("Reached ");
-      Serial.print(halfSteps * NUM_DEGREES_PER_HALF_STEP);
-      Serial.print(" degrees. halfSteps = ");
-      Serial.print(halfSteps);
-      Serial.println(". Pausing motor.");
-    }
-
-    //----------------------------------------------
-    // print current position at regular intervals to let PC software know where we are.
-    //----------------------------------------------
-//    if ((halfSteps % (STEPS_PER_REVOLUTION / 16)) == 0) {      // print rposition 8 times every revolution
-
-      // Print angle in degrees and number of half steps.
-      Serial.print(halfSteps * NUM_DEGREES_PER_HALF_STEP);
-      Serial.print(" ");
-      Serial.println(halfSteps);
-      
-//    }
-
-    //----------------------------------------------
-    // apply a delay that was set earlier based on the desired rpm of the motor.
-    //----------------------------------------------
-     delay(delayMs);
-
-    //-----------------------------------------------------------------------------------------------------
-  } // if (runMotor)
-
-  // Read commands that may have arrived from the PC. Execute them.
-  ReadAndExecuteCommand();
-}
+#include <AFMotor.h>
+#include <string.h>
+#include <math.h>
+
+#define  STEPS_PER_REVOLUTION         200
+#define  POSITIONS_PER_STEP           MICROSTEPS                          // position is counted in microsteps of the motor shield library
+#define  POSITIONS_PER_REVOLUTION     (STEPS_PER_REVOLUTION * POSITIONS_PER_STEP)
+
+#define  STEPS_AT_RESET_POSITION      (STEPS_PER_REVOLUTION * 3 / 4)      // 270 degrees.  vertical down position of vector.
+#define  POSITION_AT_RESET            (STEPS_AT_RESET_POSITION * POSITIONS_PER_STEP)
+
+#define  NUM_POSITIONS_PER_DEGREE     (POSITIONS_PER_REVOLUTION / 360.0)
+#define  NUM_DEGREES_PER_POSITION     (360.0 / POSITIONS_PER_REVOLUTION)
+
+#define  CMD_BUF_LEN                  10
+#define  CMD_RING_LEN                 8       // max number of received commands waiting to be executed
+#define  POS_RING_LEN                 8       // max number of positions waiting to be reported to PC
+#define  POS_LINE_MAX_LEN             26      // "359.8875 3199 4294967295\r\n"
+#define  POS_REPORT_MIN_INTERVAL_US   2500    // position lines use at most 90% of serial at 115200 baud, rest is for replies
+
+#define  TIMER1_PRESCALER             256     // timer 1 ticks every 16 us. Longest step interval is ~1 s.
+#define  TIMER1_TICKS_PER_SECOND      (F_CPU / TIMER1_PRESCALER)
+#define  TICK_FRACTION_BITS           8       // step intervals are kept in 1/256 timer ticks, so that ramps are smooth
+#define  MAX_STEP_TICKS               (65536UL << TICK_FRACTION_BITS)
+
+#define  ACCELERATION_RPM_PER_SEC     20.0    // motor reaches the top speed of 13 rpm in 0.65 s
+
+/*
+ * A command received from PC, parsed once when its new line is received.
+ */
+struct Command
+{
+  unsigned char   id;
+  float           arg;            // number following the id, if any.  e.g. 90 for 'g90'
+};
+
+/*
+ * Position reached by a step, saved by the timer interrupt to be printed by loop().
+ */
+struct PositionReport
+{
+  int             position;
+  unsigned long   timeUs;         // micros() when the step was taken
+};
+
+typedef void (*CommandHandler)(const Command &cmd, int param);
+
+struct CommandTableEntry
+{
+  unsigned char   id;
+  CommandHandler  handler;
+  int             param;          // fixed parameter for the handler.  e.g. rpm for speed commands
+};
+
+// Connect a stepper motor with 48 steps per revolution (7.5 degree)
+//   - to motor port #1 (M1 and M2)
+//   - to motor port #2 (M3 and M4)
+AF_Stepper motor(STEPS_PER_REVOLUTION, 1);
+
+//------------------------------------------------------------------------
+// Variables marked volatile are shared with the timer interrupt, which steps the motor.
+// Multi-byte ones must be accessed with interrupts disabled.
+//------------------------------------------------------------------------
+int             rpm                   = 3;
+volatile int    position              = POSITION_AT_RESET;                // one and only variable that maintains position of the motor.
+unsigned char   cmdBuf[CMD_BUF_LEN];
+unsigned int    cmdBufIndex           = 0;
+Command         cmdRing[CMD_RING_LEN];
+unsigned char   cmdRingHead           = 0;    // where the next received command is saved
+unsigned char   cmdRingTail           = 0;    // oldest command not yet executed
+PositionReport  posRing[POS_RING_LEN];
+volatile unsigned char posRingHead    = 0;    // where the next position is saved by the timer interrupt
+volatile unsigned char posRingTail    = 0;    // oldest position not yet printed
+unsigned long   lastPositionReportUs  = 0;    // micros() when the last position line was printed
+volatile bool   runMotor              = false;
+volatile bool   stopRequested         = false;    // motor is slowing down to pause
+unsigned long   stepIntervalUs;
+volatile unsigned long cruiseTicks;           // step interval at the set rpm, in 1/256 timer ticks
+volatile unsigned long startTicks;            // first step interval when accelerating from standstill
+volatile unsigned long stepTicks;             // current step interval
+volatile unsigned int  rampSteps      = 0;    // steps taken to accelerate to the current speed. as many are needed to stop.
+volatile unsigned char stepType       = INTERLEAVE;
+volatile int    targetPosition        = -1;
+volatile bool   isCounterClockwise    = true;     // direction the motor is turning
+volatile bool   requestedCounterClockwise = true; // direction asked by PC. motor slows down to reverse.
+volatile bool   doHalfStep            = false;
+volatile bool   halfStepDone          = false;    // set by timer interrupt. cleared by loop() after reporting.
+volatile bool   targetReached         = false;    // set by timer interrupt. cleared by loop() after reporting.
+
+void calculate_step_interval();
+void setup_step_timer();
+void update_step_timer();
+void step_motor();
+void plan_next_step(unsigned char curStepType);
+void configure_motor_rpm(int rpm_to_set);
+void read_commands();
+void execute_commands();
+void ReadAndExecuteCommand();
+int  positions_per_step(unsigned char type);
+int  position_of_angle(float angleInDegrees);
+int  positions_to_target();
+void report_position(int positionToReport, unsigned long timeUs);
+void report_motion_completed();
+void report_events();
+void report_motion_profile();
+
+/*
+ * Executed only once at bootup.
+ */
+void setup()
+{
+  Serial.begin(115200);           // set up Serial library at 9600 bps
+  Serial.println("Rotating vector application ready");
+
+  calculate_step_interval();
+  setup_step_timer();
+
+  report_motion_profile();
+}
+
+/*
+ * Number of positions the motor moves by in one step of the given type.
+ */
+int positions_per_step(unsigned char type)
+{
+  switch (type)
+  {
+    case INTERLEAVE:  return POSITIONS_PER_STEP / 2;
+    case MICROSTEP:   return 1;
+    default:          return POSITIONS_PER_STEP;      // SINGLE or DOUBLE
+  }
+}
+
+/*
+ * Position of the step nearest to the angle, for the set step type. Motor only stops at multiples of its step.
+ */
+int position_of_angle(float angleInDegrees)
+{
+  int positionsPerStep = positions_per_step(stepType);
+  long steps = long(round(angleInDegrees * NUM_POSITIONS_PER_DEGREE / positionsPerStep));
+  long newPosition = (steps * positionsPerStep) % POSITIONS_PER_REVOLUTION;
+
+  if (newPosition < 0)
+    newPosition += POSITIONS_PER_REVOLUTION;
+  return int(newPosition);
+}
+
+/*
+ * Positions to go in the current direction to reach the 'g' target, 0 .. POSITIONS_PER_REVOLUTION-1.
+ */
+int positions_to_target()
+{
+  int remainingPositions = (isCounterClockwise ? (targetPosition - position) : (position - targetPosition)) % POSITIONS_PER_REVOLUTION;
+  if (remainingPositions < 0)
+    remainingPositions += POSITIONS_PER_REVOLUTION;
+  return remainingPositions;
+}
+
+/*
+ * Time between steps for the set rpm, and the first step interval of the acceleration ramp.
+ * Both are calculated once here, so that the timer interrupt only needs integer arithmetic.
+ */
+void calculate_step_interval()
+{
+  float us_in_1_minute          = 1000000.0 * 60;
+  float steps_per_revolution    = POSITIONS_PER_REVOLUTION / positions_per_step(stepType);
+
+  float one_rpm_interval_in_us  = us_in_1_minute / steps_per_revolution;
+  
+  stepIntervalUs                = one_rpm_interval_in_us / rpm;
+
+  float ticks_per_us            = TIMER1_TICKS_PER_SECOND / 1000000.0;
+  float cruise                  = stepIntervalUs * ticks_per_us * (1 << TICK_FRACTION_BITS);
+
+  //------------------------------------------------------------------------
+  // Interval of the first step for constant acceleration (D. Austin, "Generate stepper-motor speed
+  // profiles in real time"). 0.676 corrects the error of the approximation used for later steps.
+  //------------------------------------------------------------------------
+  float acceleration            = ACCELERATION_RPM_PER_SEC / 60.0 * steps_per_revolution;    // steps / s^2
+  float start                   = 0.676 * TIMER1_TICKS_PER_SECOND * sqrt(2.0 / acceleration) * (1 << TICK_FRACTION_BITS);
+
+  noInterrupts();
+  cruiseTicks                   = (cruise < MAX_STEP_TICKS) ? (unsigned long)cruise : MAX_STEP_TICKS;
+  startTicks                    = (start  < MAX_STEP_TICKS) ? (unsigned long)start  : MAX_STEP_TICKS;
+  interrupts();
+}
+
+/*
+ * Timer 1 in CTC mode generates an interrupt every 'OCR1A + 1' ticks. The interrupt steps the motor,
+ * so step timing doesn't depend on what loop() is doing. Interrupt is enabled only while the motor runs.
+ */
+void setup_step_timer()
+{
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS12);      // CTC mode with OCR1A as top. prescaler 256.
+  OCR1A  = 0xFFFF;
+  TCNT1  = 0;
+  TIMSK1 = 0;
+  interrupts();
+}
+
+/*
+ * Start or stop stepping as per 'runMotor'. A motor that starts running takes its first step right away,
+ * and accelerates from there. Speed changes of a running motor are handled by the timer interrupt itself.
+ */
+void update_step_timer()
+{
+  noInterrupts();
+
+  if (!runMotor)
+  {
+    // immediate stop. e.g. coils are released.
+    TIMSK1 &= ~_BV(OCIE1A);
+    rampSteps = 0;
+    stopRequested = false;
+  }
+  else if (!(TIMSK1 & _BV(OCIE1A)))
+  {
+    isCounterClockwise = requestedCounterClockwise;
+    stopRequested = false;
+    rampSteps = 0;
+    stepTicks = startTicks;
+
+    step_motor();
+
+    if (runMotor)
+    {
+      TCNT1  = 0;
+      TIFR1  = _BV(OCF1A);              // discard compare match that happened while the interrupt was disabled
+      TIMSK1 |= _BV(OCIE1A);
+    }
+  }
+
+  interrupts();
+}
+
+/*
+ * 
+ */
+void configure_motor_rpm(int rpm_to_set)
+{
+  rpm = rpm_to_set;
+  calculate_step_interval();
+  
+  runMotor = true;
+  update_step_timer();
+  
+  Serial.print("Running motor at ");
+  Serial.print(rpm);
+  Serial.println(" rpm");
+}
+
+//------------------------------------------------------------------------
+// Command handlers.  'param' is the fixed parameter from command table.
+//------------------------------------------------------------------------
+void cmd_set_rpm(const Command &, int param)
+{
+  configure_motor_rpm(param);
+}
+
+//------------------------------------------------------------------------
+// go to a specific angle and stop.
+//------------------------------------------------------------------------
+void cmd_goto(const Command &cmd, int)
+{
+  float targetAngle = cmd.arg;
+  // keep step interval unchanged so that the speed at which this happens is the same.
+  int target = position_of_angle(targetAngle);
+
+  Serial.print("Going to ");
+  Serial.print(targetAngle);
+  Serial.print(" degrees.  targetPosition = ");
+  Serial.println(target);
+
+  noInterrupts();
+  targetPosition = target;
+  interrupts();
+
+  runMotor = true;     // run the motor in case we were paused.
+  update_step_timer();
+}
+
+//------------------------------------------------------------------------
+// select direction of vector rotation
+//------------------------------------------------------------------------
+void cmd_set_direction(const Command &, int param)
+{
+  noInterrupts();
+  requestedCounterClockwise = param;
+  if (!runMotor)
+    isCounterClockwise = param;         // a running motor slows down to standstill before reversing
+  interrupts();
+}
+
+//------------------------------------------------------------------------
+// half step only
+//------------------------------------------------------------------------
+void cmd_half_step(const Command &, int)
+{
+  doHalfStep = true;
+  runMotor = true;
+  update_step_timer();
+
+  // if step type is not half step, it will be temporarily set to half step just before acutally stepping the motor.
+}
+
+//------------------------------------------------------------------------
+// calibrate current position to the given angle in degrees
+//------------------------------------------------------------------------
+void cmd_calibrate(const Command &cmd, int)
+{
+  int calibrationAngle = int(cmd.arg);
+  Serial.print("Calibrating current position to ");
+  Serial.print(calibrationAngle);
+  Serial.print(" degrees. ");
+
+  int newPosition = position_of_angle(calibrationAngle);
+  noInterrupts();
+  position = newPosition;
+  interrupts();
+
+  Serial.print("New nstep = ");
+  Serial.println(newPosition / POSITIONS_PER_STEP);
+}
+
+//------------------------------------------------------------------------
+// set the mode of energizing the coils.
+//------------------------------------------------------------------------
+void cmd_set_step_type(const Command &, int param)
+{
+  int oldPositionsPerStep = positions_per_step(stepType);
+  int newPositionsPerStep = positions_per_step(param);
+
+  //------------------------------------------------------------------------
+  // Keep the angular speed of a running motor. Interval between smaller steps is proportionally shorter,
+  // and it takes proportionally more of them to stop.
+  //------------------------------------------------------------------------
+  noInterrupts();
+  stepType  = param;
+  stepTicks = stepTicks / oldPositionsPerStep * newPositionsPerStep;
+  rampSteps = (unsigned long)rampSteps * oldPositionsPerStep / newPositionsPerStep;
+  interrupts();
+
+  // keep the set rpm
+  calculate_step_interval();
+}
+
+//------------------------------------------------------------------------
+// Reset
+//------------------------------------------------------------------------
+void cmd_reset(const Command &, int)
+{
+  runMotor = false;
+  update_step_timer();
+
+  noInterrupts();
+  position = POSITION_AT_RESET;
+  interrupts();
+
+  motor.release();        // coils will be released. stick will fall to 270 degree position due to gravity.
+  Serial.println("Releasing motor coils.  Vector should fall to 270 degree position.");
+}
+
+//------------------------------------------------------------------------
+// Pause the motor
+//------------------------------------------------------------------------
+void cmd_pause(const Command &, int)
+{
+  // motor slows down and pauses by itself.
+  stopRequested = true;
+  Serial.println("Pausing motor");
+}
+
+//------------------------------------------------------------------------
+// continue running a paused motor
+//------------------------------------------------------------------------
+void cmd_continue(const Command &, int)
+{
+  stopRequested = false;
+  runMotor = true;
+  update_step_timer();
+  Serial.println("Resuming motor at speed set earlier");
+}
+
+//------------------------------------------------------------------------
+// report the motion profile, so that PC can predict the motion of the vector
+//------------------------------------------------------------------------
+void cmd_print_profile(const Command &, int)
+{
+  report_motion_profile();
+}
+
+//------------------------------------------------------------------------
+// print internal variables for debug purpose
+//------------------------------------------------------------------------
+void cmd_print_state(const Command &, int)
+{
+  Serial.print("rpm=");
+  Serial.print(rpm);
+  Serial.print(", position=");
+  Serial.print(position);
+  Serial.print(", runMotor=");
+  Serial.print(runMotor);
+  Serial.print(", stepIntervalUs=");
+  Serial.print(stepIntervalUs);
+  Serial.print(", rampSteps=");
+  Serial.print(rampSteps);
+  Serial.print(", stepType=");
+  Serial.print(stepType);
+  Serial.print(", targetPosition=");
+  Serial.print(targetPosition);
+  Serial.print(", isCounterClockwise=");
+  Serial.print(isCounterClockwise);
+  Serial.print(", doHalfStep=");
+  Serial.print(doHalfStep);
+  Serial.println();
+}
+
+/*
+ * Maps command id (first character of the command) to its handler.
+ */
+const CommandTableEntry commandTable[] =
+{
+  { '1',  cmd_set_rpm,          3           },
+  { '2',  cmd_set_rpm,          4           },
+  { '3',  cmd_set_rpm,          5           },
+  { '4',  cmd_set_rpm,          6           },
+  { '5',  cmd_set_rpm,          10          },
+  { '6',  cmd_set_rpm,          13          },
+  { 'g',  cmd_goto,             0           },
+  { '<',  cmd_set_direction,    true        },
+  { '>',  cmd_set_direction,    false       },
+  { 'h',  cmd_half_step,        0           },
+  { '=',  cmd_calibrate,        0           },
+  { 's',  cmd_set_step_type,    SINGLE      },
+  { 'd',  cmd_set_step_type,    DOUBLE      },
+  { 'i',  cmd_set_step_type,    INTERLEAVE  },
+  { 'u',  cmd_set_step_type,    MICROSTEP   },
+  { 'r',  cmd_reset,            0           },
+  { 'p',  cmd_pause,            0           },
+  { 'c',  cmd_continue,         0           },
+  { 'm',  cmd_print_profile,    0           },
+  { '?',  cmd_print_state,      0           },
+};
+
+#define  NUM_COMMANDS                 (sizeof(commandTable) / sizeof(commandTable[0]))
+
+/*
+ * Read all serial bytes received from PC. Each command is a character, optionally followed by a number, followed by a new line.
+ * A complete command is parsed once and saved in the command ring to be executed by execute_commands().
+ */
+void read_commands()
+{
+  unsigned char data;
+
+  //---------------------------------------------------------------------------------
+  // Save serial bytes to command buffer. Increment index.
+  // If received byte was new line, replace it with a null byte (string terminator).
+  // If more bytes received than allocated for, restart saving from beginning of buffer.
+  //---------------------------------------------------------------------------------
+  while (Serial.available())
+  {
+    data = Serial.read();
+
+    if (data == '\n')
+      data = 0;
+
+    cmdBuf[cmdBufIndex++] = data;       // save data byte to buffer. increment index.
+
+    if (data == 0)
+    {
+      // cmdBuf is a null terminated string. Ignore empty lines.
+      if (cmdBufIndex > 1)
+      {
+        unsigned char nextHead = (cmdRingHead + 1) % CMD_RING_LEN;
+
+        // if the ring is full, the command is dropped.
+        if (nextHead != cmdRingTail)
+        {
+          cmdRing[cmdRingHead].id  = cmdBuf[0];
+          cmdRing[cmdRingHead].arg = atof((const char*) (cmdBuf + 1));
+          cmdRingHead = nextHead;
+        }
+      }
+      cmdBufIndex = 0;
+    }
+    else
+    {
+      if (cmdBufIndex >= CMD_BUF_LEN) {
+        cmdBufIndex = 0;    // discard everything we got so far and start over.
+      }
+    }
+  } // while Serial.available()
+}
+
+/*
+ * Execute all commands waiting in the command ring.
+ */
+void execute_commands()
+{
+  // A half step must be taken before the commands following 'h' are executed. E.g. PC sends '>', 'h', '<' to
+  // half step clockwise. Remaining commands are executed after the half step.
+  while ((cmdRingTail != cmdRingHead) && !doHalfStep)
+  {
+    Command cmd = cmdRing[cmdRingTail];
+    cmdRingTail = (cmdRingTail + 1) % CMD_RING_LEN;
+
+    // any new command invalidates the 'g' command if it was in progress.
+    noInterrupts();
+    targetPosition = -1;
+    interrupts();
+
+    for (unsigned int i = 0; i < NUM_COMMANDS; i++)
+    {
+      if (commandTable[i].id == cmd.id)
+      {
+        commandTable[i].handler(cmd, commandTable[i].param);
+        break;
+      }
+    }
+  }
+}
+
+/*
+ * Print angle in degrees, position (in microsteps) and the time (in us) at which this position was reached.
+ * PC uses the time to measure and compensate the delay in receiving the position.
+ * When this sketch is compiled into the PC software (HOST_BUILD), position is also handed over directly. The
+ * line is still printed, so that serial is loaded exactly as on arduino.
+ */
+void report_position(int positionToReport, unsigned long timeUs)
+{
+#ifdef HOST_BUILD
+  hal_reportPosition(positionToReport, timeUs);
+#endif
+  Serial.print(positionToReport * NUM_DEGREES_PER_POSITION, 4);
+  Serial.print(" ");
+  Serial.print(positionToReport);
+  Serial.print(" ");
+  Serial.println(timeUs);
+}
+
+/*
+ * Motor paused by itself after a half step or after reaching the 'g' target. Only the PC software
+ * compiled with this sketch (HOST_BUILD) needs to know.
+ */
+void report_motion_completed()
+{
+#ifdef HOST_BUILD
+  hal_reportMotionCompleted();
+#endif
+}
+
+/*
+ * Print whatever the timer interrupt recorded since last time. Serial is never used from the interrupt.
+ */
+void report_events()
+{
+  //----------------------------------------------
+  // report position to let PC software know where we are. When serial can't keep up (e.g. microstepping at
+  // high rpm), only the latest position is worth sending. Don't wait for serial; try again in next loop().
+  // Position lines are spaced out, so that replies to commands don't queue up behind them.
+  //----------------------------------------------
+  while (posRingTail != posRingHead)
+  {
+    if ((Serial.availableForWrite() < POS_LINE_MAX_LEN) || (micros() - lastPositionReportUs < POS_REPORT_MIN_INTERVAL_US))
+      break;
+
+    unsigned char latest = (posRingHead + POS_RING_LEN - 1) % POS_RING_LEN;
+    PositionReport report = posRing[latest];
+    posRingTail = (latest + 1) % POS_RING_LEN;
+
+    lastPositionReportUs = micros();
+    report_position(report.position, report.timeUs);
+  }
+
+  if (targetReached)
+  {
+    targetReached = false;
+
+    noInterrupts();
+    int reachedPosition = position;
+    interrupts();
+
+    Serial.print("Reached ");
+    Serial.print(reachedPosition * NUM_DEGREES_PER_POSITION);
+    Serial.print(" degrees. position = ");
+    Serial.print(reachedPosition);
+    Serial.println(". Pausing motor.");
+
+    report_motion_completed();
+  }
+
+  if (halfStepDone)
+  {
+    halfStepDone = false;
+    report_motion_completed();
+  }
+}
+
+/*
+ * Acceleration in degrees / s^2 used for starts, stops, speed changes and reversals, and the number of
+ * positions per revolution. PC needs the latter to convert reported positions to angles.
+ */
+void report_motion_profile()
+{
+  Serial.print("profile ");
+  Serial.print(ACCELERATION_RPM_PER_SEC * 360.0 / 60.0);
+  Serial.print(" ");
+  Serial.println(POSITIONS_PER_REVOLUTION);
+}
+
+/*
+ * Read commands from PC and execute them.
+ */
+void ReadAndExecuteCommand()
+{
+  read_commands();
+  execute_commands();
+}
+
+/*
+ * Turn motor by 1 step in the set direction. Called from the timer interrupt, or with interrupts disabled.
+ */
+void step_motor()
+{
+  // Possible values for 2nd argument to .onestep() are
+  //    - SINGLE - One coil is energized at a time.
+  //    - DOUBLE - Two coils are energized at a time for more torque.
+  //    - INTERLEAVE - Alternate between single and double to create a half-step in between.
+  //                   This can result in smoother operation, but because of the extra half-step, the speed is reduced by half too.
+  //    - MICROSTEP - Adjacent coils are ramped up and down to create a number of 'micro-steps' between each full step.
+  //                  This results in finer resolution and smoother rotation, but with a loss in torque.
+  //                  Abhir's note: microstepping does not work with motor.onestep()
+  //                  It can still be selected with the 'u' command, for shields where it works. Each step is
+  //                  then one microstep (1 / MICROSTEPS of a full step).
+
+  // step type is temporarily half step when single stepping.
+  unsigned char curStepType = doHalfStep ? INTERLEAVE : stepType;
+
+  //------------------------------------------------------------------
+  // Perform a single step in the set direction.
+  //------------------------------------------------------------------
+  if (isCounterClockwise)
+    motor.onestep(BACKWARD, curStepType);
+   else
+    motor.onestep(FORWARD, curStepType); 
+
+  
+  //------------------------------------------------------------------
+  // update position by the amount moved by the step.
+  //------------------------------------------------------------------
+  if (isCounterClockwise)
+    position += positions_per_step(curStepType);
+  else
+    position -= positions_per_step(curStepType);
+
+  //----------------------------------------------
+  // rebase to 0 if gone over a full revolution.
+  //----------------------------------------------
+  // for counterclockwise direction, position will go over a revolution
+  if (isCounterClockwise)
+  {
+    if (position >= POSITIONS_PER_REVOLUTION)
+      position -= POSITIONS_PER_REVOLUTION;
+  }
+  else
+  {
+    // for clockwise direction, position will be decremented, hence will go below zero.
+    if (position <= 0)
+      position += POSITIONS_PER_REVOLUTION;
+  }
+
+  //----------------------------------------------
+  // Save the position for loop() to report. If PC is not keeping up, the position is dropped.
+  //----------------------------------------------
+  unsigned char nextHead = (posRingHead + 1) % POS_RING_LEN;
+  if (nextHead != posRingTail)
+  {
+    posRing[posRingHead].position   = position;
+    posRing[posRingHead].timeUs     = micros();
+    posRingHead = nextHead;
+  }
+  
+  //----------------------------------------------
+  // If asked to advance by just 1 degree, pause the motor.
+  //----------------------------------------------
+  if (doHalfStep)
+  {
+    doHalfStep = false;     // we are done half stepping
+    runMotor = false;         // pause the motor
+    halfStepDone = true;
+  }
+
+  //----------------------------------------------
+  // were we asked to go to a specific angle?  If yes, and if we reached that (or went past it, when it isn't at
+  // a multiple of this step, e.g. after a change of step type), stop.
+  //----------------------------------------------
+  if ((targetPosition != -1) &&
+      ((positions_to_target() == 0) || (positions_to_target() > POSITIONS_PER_REVOLUTION - positions_per_step(curStepType))))
+  {
+    runMotor = false;
+    targetPosition = -1;
+    targetReached = true;
+  }
+
+  if (runMotor)
+    plan_next_step(curStepType);
+
+  if (runMotor)
+    OCR1A = ((stepTicks + (1 << (TICK_FRACTION_BITS - 1))) >> TICK_FRACTION_BITS) - 1;
+  else
+    TIMSK1 &= ~_BV(OCIE1A);
+}
+
+/*
+ * Interval until the next step, for a trapezoidal speed profile: accelerate to the set rpm, cruise, and slow
+ * down in time to stop at the 'g' target, to pause, or to reverse. Each step changes the interval as per
+ * c(n) = c(n-1) - 2 c(n-1) / (4n + 1), which is constant acceleration with integer arithmetic.
+ */
+void plan_next_step(unsigned char curStepType)
+{
+  bool slowDown = stopRequested || (requestedCounterClockwise != isCounterClockwise);
+
+  //----------------------------------------------
+  // slow down if the 'g' target is within the steps needed to get down to the slowest speed
+  //----------------------------------------------
+  if (targetPosition != -1)
+  {
+    unsigned int remainingSteps = positions_to_target() / positions_per_step(curStepType);
+    if (remainingSteps < rampSteps)
+      slowDown = true;
+  }
+
+  if (slowDown || (stepTicks < cruiseTicks))
+  {
+    if (rampSteps > 1)
+    {
+      // mirror image of acceleration. ramp ends at c(1), as c(0) is the wait before the first step.
+      stepTicks += 2 * stepTicks / (4 * rampSteps - 1);
+      rampSteps--;
+
+      if (!slowDown && (stepTicks > cruiseTicks))
+        stepTicks = cruiseTicks;
+    }
+    else if (stopRequested)
+    {
+      // slowest speed reached. this was the last step.
+      stopRequested = false;
+      runMotor = false;
+      rampSteps = 0;
+    }
+    else if (requestedCounterClockwise != isCounterClockwise)
+    {
+      // slowest speed reached. next step is in the other direction.
+      isCounterClockwise = requestedCounterClockwise;
+    }
+    else if (!slowDown)
+    {
+      // set rpm is slower than the start of the ramp
+      stepTicks = cruiseTicks;
+    }
+  }
+  else if (stepTicks > cruiseTicks)
+  {
+    rampSteps++;
+    stepTicks -= 2 * stepTicks / (4 * rampSteps + 1);
+
+    if (stepTicks < cruiseTicks)
+      stepTicks = cruiseTicks;
+  }
+
+  if (stepTicks > MAX_STEP_TICKS)
+    stepTicks = MAX_STEP_TICKS;
+}
+
+/*
+ * Step interval elapsed.
+ */
+ISR(TIMER1_COMPA_vect)
+{
+  step_motor();
+}
+
+/*
+ * Motor is stepped by the timer interrupt. loop() only deals with serial, so commands are executed
+ * as soon as they arrive.
+ */
+void loop()
+{
+  // Read commands that may have arrived from the PC. Execute them.
+  ReadAndExecuteCommand();
+
+  report_events();
+}
@@ -1,54 +1,94 @@
-#-------------------------------------------------
-#
-# Project created by QtCreator 2018-10-02T01:54:35
-#
-#-------------------------------------------------
-
-QT       += core gui serialport
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = RotatingVector
-TEMPLATE = app
-
-# The following define makes your compiler emit warnings if you use
-# any feature of Qt which has been marked as deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if you use deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-CONFIG += c++11
-
-RC_ICONS = rotating_vector.ico
-
-SOURCES += \
-        main.cpp \
-        mainwindow.cpp \
-    renderwidget.cpp \
-    controlwindow.cpp \
-    arduinosimulator.cpp \
-    aboutdialog.cpp \
-    projection.cpp
-
-HEADERS += \
-        mainwindow.h \
-    renderwidget.h \
-    controlwindow.h \
-    arduinosimulator.h \
-    aboutdialog.h \
-    projection.h
-
-FORMS += \
-        mainwindow.ui \
-    controlwindow.ui \
-    aboutdialog.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
+#-------------------------------------------------
+#
+# Project created by QtCreator 2018-10-02T01:54:35
+#
+#-------------------------------------------------
+
+QT       += core gui serialport
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = RotatingVector
+TEMPLATE = app
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which has been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+CONFIG += c++11
+
+RC_ICONS = rotating_vector.ico
+
+SOURCES += \
+        main.cpp \
+        mainwindow.cpp \
+    renderwidget.cpp \
+    controlwindow.cpp \
+    arduinosimulator.cpp \
+    aboutdialog.cpp \
+    projection.cpp \
+    projectionset.cpp \
+    labelatlas.cpp \
+    trigkernel.cpp \
+    samplesink.cpp \
+    serialdecoder.cpp \
+    angleestimator.cpp \
+    latencymonitor.cpp \
+    qualitygovernor.cpp \
+    waverasterizer.cpp \
+    wavebench.cpp \
+    frameexporter.cpp \
+    presenterwindow.cpp \
+    host_firmware/arduinohal.cpp \
+    host_firmware/firmwarehost.cpp
+
+HEADERS += \
+        mainwindow.h \
+    renderwidget.h \
+    controlwindow.h \
+    arduinosimulator.h \
+    aboutdialog.h \
+    projection.h \
+    projectionset.h \
+    labelatlas.h \
+    trigkernel.h \
+    samplesink.h \
+    serialdecoder.h \
+    angleestimator.h \
+    latencymonitor.h \
+    qualitygovernor.h \
+    waverasterizer.h \
+    wavebench.h \
+    frameexporter.h \
+    presenterwindow.h \
+    paintdevice.h \
+    host_firmware/Arduino.h \
+    host_firmware/AFMotor.h \
+    host_firmware/arduinohal.h \
+    host_firmware/firmwarehost.h
+
+# The arduino SW is compiled into the simulator against the mocked arduino hardware in host_firmware.
+INCLUDEPATH += \
+    $$PWD/host_firmware \
+    $$PWD/../../../arduino/stepper_motor_rotating_vector
+
+FORMS += \
+        mainwindow.ui \
+    controlwindow.ui \
+    aboutdialog.ui
+
+# Observer and about images are compiled in, so the program doesn't depend on its working directory.
+RESOURCES += \
+    RotatingVector.qrc
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,187 @@
+#include "angleestimator.h"
+#include <math.h>
+
+/*
+ * Wrap the given angle in degrees to (-180, 180].
+ */
+static double wrapTo180(double angle)
+{
+    angle = fmod(angle, 360.0);
+    if (angle > 180.0)
+        angle -= 360.0;
+    else if (angle <= -180.0)
+        angle += 360.0;
+    return angle;
+}
+
+/*
+ * Wrap the given angle in degrees to [0, 360).
+ */
+static double wrapTo360(double angle)
+{
+    angle = fmod(angle, 360.0);
+    if (angle < 0)
+        angle += 360.0;
+    return angle;
+}
+
+void AngleEstimator::reset()
+{
+    hasSample = false;
+    isStopped = true;
+    velocity = 0;
+    acceleration = 0;
+    averageIntervalUs = 0;
+    averageStepDegrees = 0;
+}
+
+/*
+ * Motor ramps its speed at the given acceleration. 0 disables tracking of acceleration.
+ */
+void AngleEstimator::setMaxAcceleration(double degreesPerSec2)
+{
+    maxAcceleration = fabs(degreesPerSec2);
+    acceleration = qBound(-maxAcceleration, acceleration, maxAcceleration);
+}
+
+/*
+ * Change of angle over the given duration at the estimated velocity and acceleration. Slowing down ends at
+ * standstill; the motor doesn't reverse by itself.
+ */
+double AngleEstimator::getAngleChange(double durationUs)
+{
+    double t = durationUs / 1000000.0;
+
+    if ((acceleration * velocity < 0) && (t > -velocity / acceleration))
+        t = -velocity / acceleration;
+
+    return velocity * t + 0.5 * acceleration * t * t;
+}
+
+qint64 AngleEstimator::getStopTimeoutUs()
+{
+    qint64 timeoutUs = qint64(2.5 * averageIntervalUs);
+    return qBound(qint64(ESTIMATOR_MIN_STOP_TIMEOUT_US), timeoutUs, qint64(ESTIMATOR_MAX_STOP_TIMEOUT_US));
+}
+
+void AngleEstimator::addSample(qint64 timeUs, double angleInDegrees)
+{
+    if (!hasSample)
+    {
+        hasSample = true;
+        lastSampleTimeUs = timeUs;
+        lastSampledAngle = angleInDegrees;
+        estimatedAngle = angleInDegrees;
+        return;
+    }
+
+    double change = wrapTo180(angleInDegrees - lastSampledAngle);
+    double sampledAngle = lastSampledAngle + change;
+    qint64 intervalUs = timeUs - lastSampleTimeUs;
+
+    //----------------------------------------------------------------------
+    // Jump in position (e.g. after calibration). Start over from the new angle.
+    //----------------------------------------------------------------------
+    if (fabs(change) > ESTIMATOR_MAX_CONTINUOUS_DEGREES)
+    {
+        reset();
+        addSample(timeUs, angleInDegrees);
+        return;
+    }
+
+    if (intervalUs <= 0)
+    {
+        // More than one sample received at the same time (e.g. in one serial read). Time didn't advance,
+        // so there is nothing to learn about velocity.
+        estimatedAngle += ESTIMATOR_ALPHA * (sampledAngle - estimatedAngle);
+    }
+    else if (isStopped || (intervalUs > getStopTimeoutUs()) || (change * velocity < 0))
+    {
+        //----------------------------------------------------------------------
+        // Motor started after being stopped, or changed direction. Previous velocity is meaningless.
+        //----------------------------------------------------------------------
+        estimatedAngle = sampledAngle;
+        velocity = change * 1000000.0 / intervalUs;
+        acceleration = 0;
+        averageIntervalUs = double(intervalUs);
+        averageStepDegrees = fabs(change);
+        isStopped = false;
+    }
+    else
+    {
+        //----------------------------------------------------------------------
+        // Alpha-beta(-gamma) update
+        //----------------------------------------------------------------------
+        double intervalSec = intervalUs / 1000000.0;
+        double predictedAngle = estimatedAngle + getAngleChange(intervalUs);
+        double residual = sampledAngle - predictedAngle;
+
+        estimatedAngle = predictedAngle + ESTIMATOR_ALPHA * residual;
+        velocity += acceleration * intervalSec + ESTIMATOR_BETA * residual / intervalSec;
+
+        if (maxAcceleration > 0)
+        {
+            acceleration += ESTIMATOR_GAMMA * 2 * residual / (intervalSec * intervalSec);
+            acceleration = qBound(-maxAcceleration, acceleration, maxAcceleration);
+        }
+
+        averageIntervalUs += ESTIMATOR_INTERVAL_SMOOTHING * (intervalUs - averageIntervalUs);
+        averageStepDegrees += ESTIMATOR_INTERVAL_SMOOTHING * (fabs(change) - averageStepDegrees);
+    }
+
+    if (intervalUs > 0)
+        lastSampleTimeUs = timeUs;
+    lastSampledAngle = sampledAngle;
+}
+
+/*
+ * Angle in [0, 360) degrees at 'leadUs' after the given time.
+ */
+double AngleEstimator::predictAngle(qint64 timeUs, qint64 leadUs)
+{
+    if (!hasSample)
+        return 0;
+
+    qint64 elapsedUs = timeUs - lastSampleTimeUs;
+
+    //----------------------------------------------------------------------
+    // No sample for too long. Motor has stopped. Snap back to where it reported to be.
+    //----------------------------------------------------------------------
+    if (isStopped || (elapsedUs > getStopTimeoutUs()))
+    {
+        isStopped = true;
+        velocity = 0;
+        acceleration = 0;
+        return wrapTo360(lastSampledAngle);
+    }
+
+    double angle = estimatedAngle + getAngleChange(double(qMax(elapsedUs + leadUs, qint64(0))));
+
+    // don't get ahead of (or behind) the last sampled angle by more than one step plus the steps taken during lead.
+    double maxDifference = averageStepDegrees;
+    if (averageIntervalUs > 0)
+        maxDifference += averageStepDegrees * leadUs / averageIntervalUs;
+
+    angle = qBound(lastSampledAngle - maxDifference, angle, lastSampledAngle + maxDifference);
+
+    return wrapTo360(angle);
+}
+
+/*
+ * Degrees per second. Positive when rotating counter clockwise.
+ */
+double AngleEstimator::getVelocity()
+{
+    return velocity;
+}
+
+bool AngleEstimator::isMoving(qint64 timeUs)
+{
+    if (!hasSample || isStopped)
+        return false;
+
+    if (timeUs - lastSampleTimeUs > getStopTimeoutUs())
+        return false;
+
+    return fabs(velocity) > ESTIMATOR_MOVING_DEGREES_PER_SEC;
+}
@@ -0,0 +1,54 @@
+#ifndef ANGLEESTIMATOR_H
+#define ANGLEESTIMATOR_H
+
+#include <QtGlobal>
+
+#define ESTIMATOR_ALPHA                     0.5         // weight of angle residual applied to angle
+#define ESTIMATOR_BETA                      0.2         // weight of angle residual applied to angular velocity
+#define ESTIMATOR_GAMMA                     0.05        // weight of angle residual applied to angular acceleration
+#define ESTIMATOR_INTERVAL_SMOOTHING        0.1         // how fast average sample interval follows the actual one
+#define ESTIMATOR_MIN_STOP_TIMEOUT_US       30000       // motor is considered stopped if no sample arrived for...
+#define ESTIMATOR_MAX_STOP_TIMEOUT_US       500000      // ...2.5 sample intervals, clamped between these limits
+#define ESTIMATOR_MAX_CONTINUOUS_DEGREES    10.0        // bigger jump between samples is a recalibration, not motion
+#define ESTIMATOR_MOVING_DEGREES_PER_SEC    1.0         // slower than this is not considered running
+
+/*************************************************************************************************
+ Alpha-beta filter on the vector angle.  Samples arrive only when the motor takes a step, which can
+ be more than 100ms apart.  The filter tracks angle and angular velocity so that the angle can be
+ predicted at the time each frame is presented, giving smooth motion between samples.
+
+ When the arduino SW reports the acceleration of its speed ramps, the filter also tracks angular
+ acceleration (alpha-beta-gamma), limited to what the motor can do.  Prediction then follows the
+ ramps instead of lagging behind them.
+
+ Prediction can lead the given time to compensate for latency.  Apart from the lead, it never runs
+ more than one step ahead of the last sample.  When samples stop arriving, the motor has stopped
+ and prediction snaps back to the last sampled angle.
+ *************************************************************************************************/
+class AngleEstimator
+{
+public:
+    void reset();
+    void addSample(qint64 timeUs, double angleInDegrees);
+    double predictAngle(qint64 timeUs, qint64 leadUs);
+    void setMaxAcceleration(double degreesPerSec2);
+    double getVelocity();
+    bool isMoving(qint64 timeUs);
+
+private:
+    bool hasSample = false;
+    bool isStopped = true;
+    qint64 lastSampleTimeUs = 0;
+    double lastSampledAngle = 0;        // unwrapped. i.e. keeps increasing past 360 when rotating counter clockwise.
+    double estimatedAngle = 0;          // unwrapped. filtered angle at 'lastSampleTimeUs'
+    double velocity = 0;                // degrees per second.  positive is counter clockwise.
+    double acceleration = 0;            // degrees per second^2
+    double maxAcceleration = 0;         // 0 if arduino SW doesn't ramp its speed
+    double averageIntervalUs = 0;       // average time between consecutive samples
+    double averageStepDegrees = 0;      // average change of angle between consecutive samples
+
+    qint64 getStopTimeoutUs();
+    double getAngleChange(double durationUs);
+};
+
+#endif // ANGLEESTIMATOR_H
@@ -1,197 +1,138 @@
-#include "arduinosimulator.h"
-#include <QTimer>
-#include "mainwindow.h"
-
-#define  STEPS_PER_REVOLUTION         200
-#define  HALF_STEPS_PER_REVOLUTION    (STEPS_PER_REVOLUTION * 2)
-
-#define  STEPS_AT_RESET_POSITION      (STEPS_PER_REVOLUTION * 3 / 4)      // 270 degrees.  vertical down position of vector.
-#define  HALF_STEPS_AT_RESET_POSITION (STEPS_AT_RESET_POSITION * 2)
-
-#define  NUM_HALF_STEPS_PER_DEGREE    (HALF_STEPS_PER_REVOLUTION / 360.0)
-#define  NUM_DEGREES_PER_HALF_STEP    (360.0 / HALF_STEPS_PER_REVOLUTION)
-
-
-ArduinoSimulator::ArduinoSimulator(QObject *parent, MainWindow *mw_) :
-    QObject(parent),
-    mw(mw_)
-{
-}
-
-void ArduinoSimulator::postCmd(QString cmd)
-{
-    cmdList.append((cmd));
-}
-
-void ArduinoSimulator::readAndExecuteCommand()
-{
-    if (cmdList.size() > 0)
-    {
-        QString cmd = cmdList.at(0);
-        cmdList.removeAt(0);
-
-        if (cmd.contains('\n'))
-        {
-            cmd.replace("\n", "\0");
-            if (cmd == "c")
-            {
-                printf("Received continue command\n");
-                runMotor = true;
-            }
-            else if (cmd == "p")
-            {
-                runMotor = false;
-            }
-            else if (cmd == "r")
-            {
-                runMotor = false;
-                halfSteps = 0;
-            }
-            else if (cmd.at(0) == 'g')
-            {
-                double targetAngle = cmd.right(cmd.length() - 1).toDouble();
-                targetHalfSteps = int(round(targetAngle * NUM_HALF_STEPS_PER_DEGREE));
-                printf("******* Target half steps = %d\n", targetHalfSteps);
-                runMotor = true;
-            }
-
-            //----------------------------------------------------
-            // Set absolute angle
-            //----------------------------------------------------
-            else if (cmd.at(0) == "=")
-            {
-                int calibrationAngle = cmd.right(cmd.length() - 1).toInt();
-                printf("Calibrating current position to: %d\n", calibrationAngle);
-
-                halfSteps = int(round(calibrationAngle * NUM_HALF_STEPS_PER_DEGREE));
-                printf("New half steps = %d\n", halfSteps);
-            }
-
-
-            //----------------------------------------------------
-            // set direction
-            //----------------------------------------------------
-            else if (cmd.at(0) == "<")
-            {
-                isCounterClockwise = true;
-            }
-            else if (cmd.at(0) == ">")
-            {
-                isCounterClockwise = false;
-            }
-
-
-            //----------------------------------------------------
-            // proceed by 1 half step in the set direction
-            //----------------------------------------------------
-            else if (cmd.at(0) == "h")
-            {
-                doHalfStep = true;
-                runMotor = true;
-            }
-
-            //----------------------------------------------------
-            // Various speed settings
-            //----------------------------------------------------
-            else if (cmd == "1")
-            {
-                runMotor = true;
-                angleIncrementInDegrees = SPEED_1_ANGLE_INCREMENT;
-            }
-            else if (cmd == "2")
-            {
-                runMotor = true;
-                angleIncrementInDegrees = SPEED_2_ANGLE_INCREMENT;
-            }
-            else if (cmd == "3")
-            {
-                runMotor = true;
-                angleIncrementInDegrees = SPEED_3_ANGLE_INCREMENT;
-            }
-            else if (cmd == "4")
-            {
-                runMotor = true;
-                angleIncrementInDegrees = SPEED_4_ANGLE_INCREMENT;
-            }
-            else if (cmd == "5")
-            {
-                runMotor = true;
-                angleIncrementInDegrees = SPEED_5_ANGLE_INCREMENT;
-            }
-            else if (cmd == "6")
-            {
-                runMotor = true;
-                angleIncrementInDegrees = SPEED_6_ANGLE_INCREMENT;
-            }
-        }
-
-    }
-}
-
-void ArduinoSimulator::tick()
-{
-    if (runMotor)
-    {
-        if (isCounterClockwise)
-        {
-            if (doHalfStep)
-                currentAngleInDegrees += 0.9;
-            else
-                currentAngleInDegrees += angleIncrementInDegrees;
-        }
-        else
-        {
-            if (doHalfStep)
-                currentAngleInDegrees -= 0.9;
-            else
-                currentAngleInDegrees -= angleIncrementInDegrees;
-        }
-
-        //----------------------------------------------
-        // rebase to 0 if gone over/under a full revolution.
-        //----------------------------------------------
-        if (isCounterClockwise)
-        {
-            if (currentAngleInDegrees >= 360)
-                currentAngleInDegrees -= 360.0;
-        }
-        else
-        {
-            if (currentAngleInDegrees < 0)
-                currentAngleInDegrees += 360.0;
-        }
-
-        //------------------------------------------------------
-        // if asked to advance by 1 half step, we just did above. pause now.
-        //------------------------------------------------------
-        if (doHalfStep)
-        {
-            doHalfStep = false;
-            runMotor = false;
-            mw->isTimePaused = true;
-        }
-
-        halfSteps = int(round(currentAngleInDegrees * NUM_HALF_STEPS_PER_DEGREE));
-
-        //----------------------------------------------
-        // were we asked to go to a specific angle?  If yes, and if we reached that, stop.
-        //----------------------------------------------
-        if ((targetHalfSteps != -1) && (targetHalfSteps == halfSteps))
-        {
-            runMotor = false;
-            targetHalfSteps = -1;
-            mw->isTimePaused = true;
-        }
-
-
-        QString statusString;
-        statusString.asprintf("%.2f %d\n", currentAngleInDegrees, halfSteps);
-
-        if (!mw->useArduino)
-        {
-            mw->processSerialLine(statusString.toUtf8());
-        }
-    }
-
-    readAndExecuteCommand();
-}
+#include "arduinosimulator.h"
+#include <QTimer>
+#include "mainwindow.h"
+
+
+ArduinoSimulator::ArduinoSimulator(QObject *parent, MainWindow *mw_) :
+    QObject(parent),
+    mw(mw_)
+{
+    //----------------------------------------------------------------
+    // Position is pushed to main window as a typed sample. No text is formatted or parsed for it.
+    //----------------------------------------------------------------
+    firmware.setPositionHandler([this](int position, uint64_t timeUs) {
+        if (!mw->useArduino)
+        {
+            AngleSample sample;
+            sample.timestampUs      = virtualToPcClockUs(qint64(timeUs));
+            sample.receivedTimeUs   = isClockExternal ? sliceEndPcClockUs : pcClockUs();
+            sample.transferTimeUs   = 0;
+            sample.angleInDegrees   = position * 360.0 / firmware.getPositionsPerRevolution();
+            sample.position         = position;
+
+            mw->pushSample(sample);
+        }
+    });
+
+    // Other lines printed by the arduino SW are messages for the user, except for the motion profile.
+    firmware.setSerialLineHandler([this](const std::string &line, uint64_t) {
+        printf("Simulated arduino: %s\n", line.c_str());
+
+        MotionProfile profile;
+        if (!mw->useArduino && SerialDecoder::decodeProfileLine(QByteArray::fromStdString(line), profile))
+            mw->setMotionProfile(profile);
+    });
+
+    // The arduino SW pauses the motor by itself after a half step or after reaching the 'g' target. Pause time too.
+    firmware.setMotionCompletedHandler([this]() {
+        mw->isTimePaused = true;
+    });
+
+    firmware.begin();
+
+    connect(clockTimer, SIGNAL(timeout()), this, SLOT(clockTimerEvent()));
+
+    lastWallClockUs = pcClockUs();
+
+    clockTimer->setTimerType(Qt::PreciseTimer);
+    clockTimer->start(SIMULATOR_CLOCK_INTERVAL_MS);
+}
+
+/*
+ * Command is received by the arduino SW as serial data, just like the real arduino.
+ */
+void ArduinoSimulator::postCmd(QString cmd)
+{
+    firmware.postSerial(cmd.toLatin1().constData());
+}
+
+/*
+ * Virtual time advances 'timeScale' times as fast as wall clock. 1.0 runs the simulator in real time.
+ */
+void ArduinoSimulator::setTimeScale(double timeScale_)
+{
+    timeScale = timeScale_;
+}
+
+double ArduinoSimulator::getTimeScale()
+{
+    return timeScale;
+}
+
+bool ArduinoSimulator::isMotorRunning()
+{
+    return firmware.isMotorRunning();
+}
+
+bool ArduinoSimulator::isCounterClockwise()
+{
+    return firmware.isCounterClockwise();
+}
+
+/*
+ * PC clock time corresponding to the given virtual time. The end of the current time slice corresponds to now.
+ */
+qint64 ArduinoSimulator::virtualToPcClockUs(qint64 timeUs)
+{
+    return sliceEndPcClockUs - qint64((virtualTimeUs - timeUs) / timeScale);
+}
+
+/*
+ * With an external clock (e.g. rendering offscreen faster than real time), virtual time no longer follows wall
+ * clock.  PC clock times of samples then follow virtual time, so that they stay consistent with each other.
+ * Clocks jump when switching, hence what was learnt from the old clock is dropped.
+ */
+void ArduinoSimulator::setExternalClock(bool isExternal)
+{
+    isClockExternal = isExternal;
+    if (!isExternal)
+        sliceEndPcClockUs = pcClockUs();
+
+    mw->latencyMonitor.reset();
+    mw->angleEstimator.reset();
+}
+
+/*
+ * PC clock time corresponding to the current virtual time. It is now, unless clock is external.
+ */
+qint64 ArduinoSimulator::getCurrentPcClockUs()
+{
+    return isClockExternal ? sliceEndPcClockUs : pcClockUs();
+}
+
+/*
+ * Run the arduino SW for the given duration of virtual time.
+ */
+void ArduinoSimulator::advanceVirtualTime(qint64 durationUs)
+{
+    virtualTimeUs += durationUs;
+    sliceEndPcClockUs = isClockExternal ? sliceEndPcClockUs + qint64(durationUs / timeScale) : pcClockUs();
+
+    firmware.runUntil(uint64_t(virtualTimeUs));
+}
+
+/*
+ * Advance virtual time by the wall clock time elapsed since the last clock event (multiplied by time scale).
+ * This is independent of how often the GUI is painted.
+ */
+void ArduinoSimulator::clockTimerEvent()
+{
+    qint64 nowUs = pcClockUs();
+    qint64 elapsedUs = qMin(nowUs - lastWallClockUs, qint64(SIMULATOR_MAX_CATCH_UP_US));
+    lastWallClockUs = nowUs;
+
+    if (!mw->useArduino && !isClockExternal)
+    {
+        advanceVirtualTime(qint64(elapsedUs * timeScale));
+    }
+}
@@ -1,45 +1,54 @@
-#ifndef ARDUINOSIMULATOR_H
-#define ARDUINOSIMULATOR_H
-
-#include <QObject>
-#include <QTimer>
-
-class MainWindow;
-
-#define SMALLEST_ANGLE_INCREMENT                (0.2)
-#define SPEED_1_ANGLE_INCREMENT                 (SMALLEST_ANGLE_INCREMENT * 1)
-#define SPEED_2_ANGLE_INCREMENT                 (SMALLEST_ANGLE_INCREMENT * 2)
-#define SPEED_3_ANGLE_INCREMENT                 (SMALLEST_ANGLE_INCREMENT * 3)
-#define SPEED_4_ANGLE_INCREMENT                 (SMALLEST_ANGLE_INCREMENT * 4)
-#define SPEED_5_ANGLE_INCREMENT                 (SMALLEST_ANGLE_INCREMENT * 5)
-#define SPEED_6_ANGLE_INCREMENT                 (SMALLEST_ANGLE_INCREMENT * 6)
-
-class ArduinoSimulator : public QObject
-{
-    Q_OBJECT
-public:
-    explicit ArduinoSimulator(QObject *parent = nullptr, MainWindow *mw_ = nullptr);
-    void postCmd(QString cmd);
-
-    bool runMotor = false;
-    bool isCounterClockwise = true;
-
-signals:
-
-public slots:
-    void tick();
-
-private:
-    double angleIncrementInDegrees = SPEED_3_ANGLE_INCREMENT;
-    double currentAngleInDegrees = 0.0;
-    int halfSteps = 0;
-    int targetHalfSteps = -1;
-    bool doHalfStep = false;
-
-    QStringList cmdList;
-    MainWindow *mw;
-
-    void readAndExecuteCommand();
-};
-
-#endif // ARDUINOSIMULATOR_H
+#ifndef ARDUINOSIMULATOR_H
+#define ARDUINOSIMULATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include "host_firmware/firmwarehost.h"
+#include "samplesink.h"
+
+class MainWindow;
+
+#define SIMULATOR_CLOCK_INTERVAL_MS             5           // how often virtual time is advanced to catch up with wall clock
+#define SIMULATOR_MAX_CATCH_UP_US               1000000     // never simulate more than this much wall clock time in one clock tick
+
+/*************************************************************************************************
+ Simulates the arduino when arduino is not connected.  The actual arduino SW is run against mocked
+ arduino hardware (see host_firmware), so the simulated vector behaves exactly like the real one.
+
+ Simulator has its own clock and is not tied to the rate at which GUI is painted.  Virtual time
+ advances with wall clock (multiplied by time scale).
+ *************************************************************************************************/
+class ArduinoSimulator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ArduinoSimulator(QObject *parent = nullptr, MainWindow *mw_ = nullptr);
+    void postCmd(QString cmd);
+    void setTimeScale(double timeScale_);
+    double getTimeScale();
+    void advanceVirtualTime(qint64 durationUs);
+    bool isMotorRunning();
+    bool isCounterClockwise();
+    qint64 virtualToPcClockUs(qint64 timeUs);
+    void setExternalClock(bool isExternal);
+    qint64 getCurrentPcClockUs();
+
+signals:
+
+public slots:
+    void clockTimerEvent();
+
+private:
+    double timeScale = 1.0;
+    qint64 virtualTimeUs = 0;           // time up to which the arduino SW has been run
+    qint64 lastWallClockUs = 0;
+    qint64 sliceEndPcClockUs = 0;       // PC clock time corresponding to 'virtualTimeUs'
+    bool isClockExternal = false;       // virtual time is advanced only by advanceVirtualTime(), not by wall clock
+
+    QTimer *clockTimer = new QTimer(this);
+
+    FirmwareHost firmware;
+    MainWindow *mw;
+};
+
+#endif // ARDUINOSIMULATOR_H
@@ -0,0 +1,249 @@
+#include "frameexporter.h"
+#include <QDir>
+#include <algorithm>
+
+
+FrameExporter::~FrameExporter()
+{
+    stop();
+}
+
+/*
+ * .y4m is a Y4M stream, .rgb or .raw is raw rgb24, anything else is a directory for a PNG sequence.
+ */
+FrameExporter::Format FrameExporter::getFormatFromPath(const QString &path)
+{
+    if (path.endsWith(".y4m", Qt::CaseInsensitive))
+        return Y4M;
+    if (path.endsWith(".rgb", Qt::CaseInsensitive) || path.endsWith(".raw", Qt::CaseInsensitive))
+        return RAW_RGB;
+    return PNG_SEQUENCE;
+}
+
+/*
+ * Frames are 'size' logical pixels at 'pixelRatio'. Returns false if the file (or directory) can't be created.
+ */
+bool FrameExporter::start(const QString &path, Format format, QSize size, qreal pixelRatio, int framesPerSecond)
+{
+    stop();
+
+    this->path = path;
+    this->format = format;
+
+    QSize deviceSize = size * pixelRatio;
+
+    //----------------------------------------------------------------
+    // File and its header.
+    //----------------------------------------------------------------
+    if (format == PNG_SEQUENCE)
+    {
+        if (!QDir().mkpath(path))
+            return false;
+    }
+    else
+    {
+        file = fopen(path.toLocal8Bit().constData(), "wb");
+        if (file == nullptr)
+            return false;
+
+        if (format == Y4M)
+            fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444 XCOLORRANGE=FULL\n", deviceSize.width(), deviceSize.height(),
+                    framesPerSecond);
+    }
+
+    //----------------------------------------------------------------
+    // Pool of frames, all free.
+    //----------------------------------------------------------------
+    pool.clear();
+    pool.reserve(FRAME_EXPORT_POOL_SIZE);          // frames are handed out by address
+    freeFrames.clear();
+    for (int i=0; i<FRAME_EXPORT_POOL_SIZE; i++)
+    {
+        pool.push_back(QImage(deviceSize, QImage::Format_ARGB32_Premultiplied));
+        pool.back().setDevicePixelRatio(pixelRatio);
+        freeFrames.push_back(&pool.back());
+    }
+    queuedFrames.clear();
+
+    numFramesWritten = 0;
+    numFramesDropped = 0;
+    numFramesFailed = 0;
+    isStreamBroken = false;
+    maxQueueDepth = 0;
+    isStopping = false;
+    isStarted = true;
+
+    writer = std::thread(&FrameExporter::writeFrames, this);
+    return true;
+}
+
+/*
+ * Frames submitted so far are written before this returns.
+ */
+void FrameExporter::stop()
+{
+    if (!isStarted)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    frameQueued.notify_one();
+    writer.join();
+
+    if (file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+    pool.clear();
+    freeFrames.clear();
+    isStarted = false;
+}
+
+bool FrameExporter::isRunning() const
+{
+    return isStarted;
+}
+
+bool FrameExporter::hasFreeFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !freeFrames.empty();
+}
+
+/*
+ * Free frame to draw into, nullptr if all are waiting to be written (the frame is dropped).  Frames are handed out
+ * in the order they were freed, so the one written last, which the presenter window may still be showing (sharing
+ * its data), isn't drawn into next; that would make QImage copy it.
+ */
+QImage *FrameExporter::acquireFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!isStarted)
+        return nullptr;
+
+    if (freeFrames.empty())
+    {
+        numFramesDropped++;
+        return nullptr;
+    }
+
+    QImage *frame = freeFrames.front();
+    freeFrames.pop_front();
+    return frame;
+}
+
+void FrameExporter::submitFrame(QImage *frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        queuedFrames.push_back(frame);
+        maxQueueDepth = std::max(maxQueueDepth, int(queuedFrames.size()));
+    }
+    frameQueued.notify_one();
+}
+
+int FrameExporter::getNumFramesWritten()    {   std::lock_guard<std::mutex> lock(mutex);    return numFramesWritten;            }
+int FrameExporter::getNumFramesDropped()    {   std::lock_guard<std::mutex> lock(mutex);    return numFramesDropped;            }
+int FrameExporter::getNumFramesFailed()     {   std::lock_guard<std::mutex> lock(mutex);    return numFramesFailed;             }
+int FrameExporter::getQueueDepth()          {   std::lock_guard<std::mutex> lock(mutex);    return int(queuedFrames.size());    }
+int FrameExporter::getMaxQueueDepth()       {   std::lock_guard<std::mutex> lock(mutex);    return maxQueueDepth;               }
+
+/*
+ * Writer thread: writes queued frames in order until stopped and the queue is empty.  Frames are numbered in the
+ * order they are taken from the queue, failed ones included, so that a PNG that failed isn't overwritten by the
+ * next frame.
+ */
+void FrameExporter::writeFrames()
+{
+    for (;;)
+    {
+        QImage *frame;
+        int frameNumber;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameQueued.wait(lock, [this] { return isStopping || !queuedFrames.empty(); });
+
+            if (queuedFrames.empty())
+                return;
+
+            frame = queuedFrames.front();
+            queuedFrames.pop_front();
+            frameNumber = numFramesWritten + numFramesFailed;
+        }
+
+        // frame is owned by this thread till it is back in the pool.
+        bool isWritten = !isStreamBroken && writeFrame(*frame, frameNumber);
+        if (!isWritten && (format != PNG_SEQUENCE))
+            isStreamBroken = true;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        freeFrames.push_back(frame);
+        if (isWritten)
+            numFramesWritten++;
+        else
+            numFramesFailed++;
+    }
+}
+
+/*
+ * Convert a frame to the file's format and write it. Alpha is dropped; frames are opaque.
+ */
+bool FrameExporter::writeFrame(const QImage &frame, int frameNumber)
+{
+    int width = frame.width();
+    int height = frame.height();
+    size_t numPixels = size_t(width) * size_t(height);
+
+    if (format == PNG_SEQUENCE)
+        return frame.save(QString("%1/frame_%2.png").arg(path).arg(frameNumber, 6, 10, QChar('0')), "PNG");
+
+    if (format == RAW_RGB)
+    {
+        planes.resize(numPixels * 3);
+        unsigned char *rgb = planes.data();
+
+        for (int y=0; y<height; y++)
+        {
+            const QRgb *line = reinterpret_cast<const QRgb *>(frame.constScanLine(y));
+            for (int x=0; x<width; x++)
+            {
+                *rgb++ = uchar(qRed(line[x]));
+                *rgb++ = uchar(qGreen(line[x]));
+                *rgb++ = uchar(qBlue(line[x]));
+            }
+        }
+        return fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+    }
+
+    //----------------------------------------------------------------
+    // Y4M: planar Y, Cb, Cr (BT.601, full range), in fixed point with 8 fraction bits.
+    //----------------------------------------------------------------
+    planes.resize(numPixels * 3);
+    unsigned char *planeY  = planes.data();
+    unsigned char *planeCb = planeY + numPixels;
+    unsigned char *planeCr = planeCb + numPixels;
+
+    for (int y=0; y<height; y++)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(frame.constScanLine(y));
+        size_t offset = size_t(y) * size_t(width);
+
+        for (int x=0; x<width; x++)
+        {
+            int r = qRed(line[x]), g = qGreen(line[x]), b = qBlue(line[x]);
+
+            planeY [offset + x] = uchar(( 77 * r + 150 * g +  29 * b + 128) >> 8);
+            planeCb[offset + x] = uchar(std::min(255, (-43 * r -  85 * g + 128 * b + 128 * 256 + 128) >> 8));
+            planeCr[offset + x] = uchar(std::min(255, (128 * r - 107 * g -  21 * b + 128 * 256 + 128) >> 8));
+        }
+    }
+
+    if (fputs("FRAME\n", file) == EOF)
+        return false;
+    return fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+}
@@ -0,0 +1,79 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <QImage>
+#include <QString>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#define FRAME_EXPORT_POOL_SIZE          8           // frames that can be waiting for (or being) written
+
+
+/*************************************************************************************************
+ Writes rendered frames to disk on a thread of its own, so that encoding doesn't hold up rendering.
+
+ Frames come from a fixed pool: renderer takes a free frame, draws into it and submits it; the
+ writer returns it to the pool once written.  If the writer falls behind and the pool runs dry, the
+ renderer gets no frame, and the frame is counted as dropped.  Frames that can't be written are
+ counted as failed; after a failed write to a raw or Y4M file, the rest of the frames fail too, as
+ the stream is cut mid frame.  Formats:
+
+    - RAW_RGB: rgb24 frames back to back, without any header (e.g. for ffmpeg -f rawvideo).
+    - Y4M: YUV4MPEG2 stream, 4:4:4, BT.601 full range, which most video tools read as is.
+    - PNG_SEQUENCE: frame_000000.png, frame_000001.png ... in a directory.
+ *************************************************************************************************/
+class FrameExporter
+{
+public:
+    enum Format { RAW_RGB, Y4M, PNG_SEQUENCE };
+
+    FrameExporter() {}
+    FrameExporter(const FrameExporter &) = delete;
+    ~FrameExporter();
+
+    static Format getFormatFromPath(const QString &path);
+
+    bool start(const QString &path, Format format, QSize size, qreal pixelRatio, int framesPerSecond);
+    void stop();
+    bool isRunning() const;
+
+    bool hasFreeFrame();
+    QImage *acquireFrame();
+    void submitFrame(QImage *frame);
+
+    int getNumFramesWritten();
+    int getNumFramesDropped();
+    int getNumFramesFailed();
+    int getQueueDepth();
+    int getMaxQueueDepth();
+
+private:
+    void writeFrames();
+    bool writeFrame(const QImage &frame, int frameNumber);
+
+    QString path;
+    Format format = RAW_RGB;
+    FILE *file = nullptr;
+    std::vector<unsigned char> planes;      // a frame converted for the file
+
+    std::vector<QImage> pool;
+    std::deque<QImage*> freeFrames;         // handed out oldest first, see acquireFrame()
+    std::deque<QImage*> queuedFrames;
+    int numFramesWritten = 0;
+    int numFramesDropped = 0;
+    int numFramesFailed = 0;                // taken from the queue but not written (e.g. disk full)
+    bool isStreamBroken = false;            // a write to the raw or Y4M file failed; nothing more is written
+    int maxQueueDepth = 0;
+    bool isStopping = false;
+    bool isStarted = false;
+
+    std::mutex mutex;                       // protects pool state and counters
+    std::condition_variable frameQueued;
+    std::thread writer;
+};
+
+#endif // FRAMEEXPORTER_H
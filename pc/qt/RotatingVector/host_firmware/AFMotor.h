@@ -0,0 +1,37 @@
+#ifndef AFMOTOR_H
+#define AFMOTOR_H
+
+/*************************************************************************************************
+ Mock of the Adafruit motor shield library.  Stepping does not move anything; it is reported to the
+ host through hal_notifyStep() so that the host knows when (in virtual time) each step was taken.
+ *************************************************************************************************/
+
+#include "Arduino.h"
+
+#define FORWARD     1
+#define BACKWARD    2
+#define BRAKE       3
+#define RELEASE     4
+
+#define SINGLE      1
+#define DOUBLE      2
+#define INTERLEAVE  3
+#define MICROSTEP   4
+
+#define MICROSTEPS  16          // same as the library. microsteps per full step.
+
+class AF_Stepper
+{
+public:
+    AF_Stepper(uint16_t steps, uint8_t num);
+    void step(uint16_t steps, uint8_t dir, uint8_t style = SINGLE);
+    void setSpeed(uint16_t rpm);
+    uint8_t onestep(uint8_t dir, uint8_t style);
+    void release();
+
+    uint16_t revsteps;
+    uint8_t steppernum;
+    uint32_t usperstep;
+};
+
+#endif // AFMOTOR_H
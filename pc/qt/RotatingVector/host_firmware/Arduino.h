@@ -0,0 +1,135 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/*************************************************************************************************
+ Mock of the parts of the arduino core used by the arduino SW, so that the sketch can be compiled
+ and run on the PC.  Time is virtual: it only advances when the sketch calls delay(), or when the
+ host advances it (see arduinohal.h).  Timer interrupts are run when virtual time reaches them.
+ *************************************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <functional>
+
+#define DEC     10
+#define HEX     16
+#define OCT     8
+#define BIN     2
+
+#define SERIAL_RX_BUFFER_SIZE   64          // same as arduino core. bytes received when buffer is full are dropped.
+#define SERIAL_TX_BUFFER_SIZE   64          // same as arduino core. print() waits when buffer is full.
+#define SERIAL_BITS_PER_BYTE    10          // start bit, 8 data bits and stop bit
+
+#define F_CPU                   16000000UL  // arduino uno
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void noInterrupts();
+void interrupts();
+
+
+//---------------------------------------------------------------------------------
+// AVR registers used by the sketch. Reads and writes go to the emulated peripherals in arduinohal.cpp.
+//---------------------------------------------------------------------------------
+#define _BV(bit)                (1 << (bit))
+#define ISR(vector)             void vector()
+
+// register bits
+#define CS10                    0
+#define CS11                    1
+#define CS12                    2
+#define WGM12                   3
+#define OCIE1A                  1
+#define OCF1A                   1
+
+enum AvrRegisterId
+{
+    REG_TCCR1A,
+    REG_TCCR1B,
+    REG_TCNT1,
+    REG_OCR1A,
+    REG_TIMSK1,
+    REG_TIFR1,
+    NUM_AVR_REGISTERS
+};
+
+uint16_t hal_readRegister(int id);
+void hal_writeRegister(int id, uint16_t value);
+
+class AvrRegister
+{
+public:
+    explicit AvrRegister(int id_) : id(id_) {}
+
+    operator uint16_t() const                   { return hal_readRegister(id);                                  }
+    AvrRegister &operator=(uint16_t value)      { hal_writeRegister(id, value);                 return *this;   }
+    AvrRegister &operator|=(uint16_t value)     { hal_writeRegister(id, uint16_t(*this | value)); return *this;   }
+    AvrRegister &operator&=(uint16_t value)     { hal_writeRegister(id, uint16_t(*this & value)); return *this;   }
+
+private:
+    int id;
+};
+
+extern AvrRegister TCCR1A;
+extern AvrRegister TCCR1B;
+extern AvrRegister TCNT1;
+extern AvrRegister OCR1A;
+extern AvrRegister TIMSK1;
+extern AvrRegister TIFR1;
+
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud);
+    int available();
+    int read();
+    int availableForWrite();
+
+    size_t print(const char *str);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println();
+    template<typename T> size_t println(T value)            { size_t n = print(value);       return n + println(); }
+    template<typename T> size_t println(T value, int arg)   { size_t n = print(value, arg);  return n + println(); }
+
+    //---------------------------------------------------------------------------------
+    // Host side of the serial link
+    //---------------------------------------------------------------------------------
+    void hostWrite(const char *data, size_t len);
+    void setLineHandler(std::function<void(const std::string &line, uint64_t sentUs)> handler);
+    unsigned long getNumBytesWritten();
+    unsigned long getBaudRate();
+
+private:
+    unsigned char rxBuffer[SERIAL_RX_BUFFER_SIZE];      // bytes sent by PC, not yet read by the sketch
+    unsigned int rxHead = 0;
+    unsigned int rxTail = 0;
+    std::string txLine;                         // bytes printed by the sketch since the last new line
+    std::function<void(const std::string &line, uint64_t sentUs)> lineHandler;
+    unsigned long numBytesWritten = 0;
+    unsigned long baudRate = 115200;
+    uint64_t txEndNs = 0;                       // virtual time (in ns) at which the last printed byte is transmitted
+
+    int getNumTxPending();
+    size_t printNumber(unsigned long n, int base, bool isNegative);
+    size_t write(const char *data, size_t len);
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
@@ -0,0 +1,422 @@
+#include "arduinohal.h"
+#include "Arduino.h"
+#include "AFMotor.h"
+#include <stdio.h>
+#include <algorithm>
+
+HardwareSerial Serial;
+
+static uint64_t virtualTimeUs = 0;
+static std::function<void(uint8_t dir, uint8_t style)> stepHandler;
+static std::function<void(int position, uint64_t timeUs)> positionHandler;
+static std::function<void()> motionCompletedHandler;
+
+static bool interruptsEnabled = true;
+static std::function<void()> timer1CompareAHandler;
+
+#define CPU_CYCLES_PER_US       (F_CPU / 1000000)
+
+static void runInterrupts(uint64_t endUs);
+
+
+/*************************************************************************************************
+ Virtual time
+ *************************************************************************************************/
+uint64_t hal_getVirtualTimeUs()                         { return virtualTimeUs;         }
+void hal_setVirtualTimeUs(uint64_t timeUs)              { virtualTimeUs = timeUs;       }
+
+/*
+ * Interrupts falling in the given duration are run at their time, as they would interrupt the sketch on arduino.
+ */
+void hal_advanceVirtualTimeUs(uint64_t durationUs)
+{
+    uint64_t endUs = virtualTimeUs + durationUs;
+
+    runInterrupts(endUs);
+    virtualTimeUs = endUs;
+}
+
+unsigned long millis()                                  { return (unsigned long)(virtualTimeUs / 1000); }
+unsigned long micros()                                  { return (unsigned long)(virtualTimeUs);        }
+void delay(unsigned long ms)                            { hal_advanceVirtualTimeUs(uint64_t(ms) * 1000); }
+void delayMicroseconds(unsigned int us)                 { hal_advanceVirtualTimeUs(us);                 }
+void noInterrupts()                                     { interruptsEnabled = false;                    }
+void interrupts()                                       { interruptsEnabled = true;                     }
+
+
+/*************************************************************************************************
+ Timer1.  Only what the sketch uses is emulated: CTC mode (counting from 0 to OCR1A) with the
+ internal clock, and the compare match A interrupt.  Interrupt flags are not emulated; interrupt
+ runs only while it is enabled.
+
+ Counter is not advanced every tick.  It is brought up to date (synced) when it is accessed, and the
+ time of the next compare match is calculated from it.
+ *************************************************************************************************/
+AvrRegister TCCR1A(REG_TCCR1A);
+AvrRegister TCCR1B(REG_TCCR1B);
+AvrRegister TCNT1(REG_TCNT1);
+AvrRegister OCR1A(REG_OCR1A);
+AvrRegister TIMSK1(REG_TIMSK1);
+AvrRegister TIFR1(REG_TIFR1);
+
+static uint16_t registers[NUM_AVR_REGISTERS];
+static uint64_t timer1SyncCycles = 0;           // CPU cycle at which counter had the value in registers[REG_TCNT1]
+
+/*
+ * CPU cycles per timer tick. 0 if timer is stopped.
+ */
+static unsigned int getTimer1Prescaler()
+{
+    switch (registers[REG_TCCR1B] & (_BV(CS12) | _BV(CS11) | _BV(CS10)))
+    {
+        case 1:     return 1;
+        case 2:     return 8;
+        case 3:     return 64;
+        case 4:     return 256;
+        case 5:     return 1024;
+        default:    return 0;       // stopped. external clock is not emulated.
+    }
+}
+
+static void syncTimer1(uint64_t cycles)
+{
+    unsigned int prescaler = getTimer1Prescaler();
+
+    if ((prescaler == 0) || (cycles <= timer1SyncCycles))
+    {
+        timer1SyncCycles = std::max(timer1SyncCycles, cycles);
+        return;
+    }
+
+    uint64_t ticks = (cycles - timer1SyncCycles) / prescaler;
+    timer1SyncCycles += ticks * prescaler;
+
+    uint32_t top   = registers[REG_OCR1A];
+    uint32_t count = registers[REG_TCNT1];
+
+    // counter above top (top was lowered) counts up to 0xFFFF and wraps to 0 first.
+    if (count > top)
+    {
+        uint64_t ticksToWrap = 0x10000 - count;
+        if (ticks < ticksToWrap)
+        {
+            registers[REG_TCNT1] = uint16_t(count + ticks);
+            return;
+        }
+        ticks -= ticksToWrap;
+        count = 0;
+    }
+
+    registers[REG_TCNT1] = uint16_t((count + ticks) % (top + 1));
+}
+
+/*
+ * CPU cycle at which counter will go from top to 0, which is when compare match A interrupt runs.
+ */
+static uint64_t getTimer1CompareCycles()
+{
+    unsigned int prescaler = getTimer1Prescaler();
+
+    if (prescaler == 0)
+        return UINT64_MAX;
+
+    uint32_t top   = registers[REG_OCR1A];
+    uint32_t count = registers[REG_TCNT1];
+    uint64_t ticks = (count <= top) ? (top - count + 1) : (0x10000 - count + top + 1);
+
+    return timer1SyncCycles + ticks * prescaler;
+}
+
+static bool isTimer1CompareAEnabled()
+{
+    return (registers[REG_TIMSK1] & _BV(OCIE1A)) && (getTimer1Prescaler() != 0) && timer1CompareAHandler;
+}
+
+uint16_t hal_readRegister(int id)
+{
+    if (id == REG_TCNT1)
+        syncTimer1(virtualTimeUs * CPU_CYCLES_PER_US);
+
+    return registers[id];
+}
+
+void hal_writeRegister(int id, uint16_t value)
+{
+    syncTimer1(virtualTimeUs * CPU_CYCLES_PER_US);
+
+    if (id != REG_TIFR1)        // writing 1 clears a flag. flags are not emulated.
+        registers[id] = value;
+}
+
+/*
+ * Sketch's interrupt service routine for TIMER1_COMPA_vect.
+ */
+void hal_setTimer1CompareAHandler(std::function<void()> handler)
+{
+    timer1CompareAHandler = handler;
+}
+
+/*
+ * Virtual time at which the next interrupt will run. UINT64_MAX if no interrupt is enabled.
+ */
+uint64_t hal_getNextInterruptUs()
+{
+    if (!isTimer1CompareAEnabled())
+        return UINT64_MAX;
+
+    return (getTimer1CompareCycles() + CPU_CYCLES_PER_US - 1) / CPU_CYCLES_PER_US;
+}
+
+/*
+ * Run interrupts due till the given time, each at its own virtual time. Interrupts are disabled while
+ * an interrupt service routine runs, like on arduino.
+ */
+static void runInterrupts(uint64_t endUs)
+{
+    while (interruptsEnabled && isTimer1CompareAEnabled())
+    {
+        uint64_t compareCycles = getTimer1CompareCycles();
+        if (compareCycles > endUs * CPU_CYCLES_PER_US)
+            break;
+
+        if (compareCycles > virtualTimeUs * CPU_CYCLES_PER_US)
+            virtualTimeUs = compareCycles / CPU_CYCLES_PER_US;
+
+        syncTimer1(compareCycles);
+
+        interruptsEnabled = false;
+        timer1CompareAHandler();
+        interruptsEnabled = true;
+    }
+}
+
+
+/*************************************************************************************************
+ Stepper motor
+ *************************************************************************************************/
+void hal_setStepHandler(std::function<void(uint8_t dir, uint8_t style)> handler)
+{
+    stepHandler = handler;
+}
+
+void hal_notifyStep(uint8_t dir, uint8_t style)
+{
+    if (stepHandler)
+        stepHandler(dir, style);
+}
+
+/*
+ * Called by the sketch instead of printing its position when compiled with HOST_BUILD.
+ */
+void hal_setPositionHandler(std::function<void(int position, uint64_t timeUs)> handler)
+{
+    positionHandler = handler;
+}
+
+/*
+ * 'timeUs' is the micros() value when the position was reached. It is extended to 64 bits, as unsigned
+ * long can be 32 bits, which wraps in about an hour of virtual time.
+ */
+void hal_reportPosition(int position, unsigned long timeUs)
+{
+    uint64_t fullTimeUs = virtualTimeUs - uint32_t(uint32_t(virtualTimeUs) - uint32_t(timeUs));
+
+    if (positionHandler)
+        positionHandler(position, fullTimeUs);
+}
+
+void hal_setMotionCompletedHandler(std::function<void()> handler)
+{
+    motionCompletedHandler = handler;
+}
+
+void hal_reportMotionCompleted()
+{
+    if (motionCompletedHandler)
+        motionCompletedHandler();
+}
+
+AF_Stepper::AF_Stepper(uint16_t steps, uint8_t num) :
+    revsteps(steps),
+    steppernum(num),
+    usperstep(0)
+{
+}
+
+void AF_Stepper::setSpeed(uint16_t rpm)
+{
+    usperstep = 60000000 / (uint32_t(revsteps) * rpm);
+}
+
+void AF_Stepper::step(uint16_t steps, uint8_t dir, uint8_t style)
+{
+    while (steps--)
+    {
+        onestep(dir, style);
+        delayMicroseconds(usperstep);
+    }
+}
+
+uint8_t AF_Stepper::onestep(uint8_t dir, uint8_t style)
+{
+    hal_notifyStep(dir, style);
+    return 0;
+}
+
+void AF_Stepper::release()
+{
+}
+
+
+/*************************************************************************************************
+ Serial
+ *************************************************************************************************/
+void HardwareSerial::begin(unsigned long baud)
+{
+    baudRate = baud;
+}
+
+int HardwareSerial::available()
+{
+    return int((SERIAL_RX_BUFFER_SIZE + rxHead - rxTail) % SERIAL_RX_BUFFER_SIZE);
+}
+
+int HardwareSerial::availableForWrite()
+{
+    return SERIAL_TX_BUFFER_SIZE - 1 - getNumTxPending();
+}
+
+/*
+ * Printed bytes still waiting in the transmit buffer. Bytes leave the buffer at baud rate.
+ */
+int HardwareSerial::getNumTxPending()
+{
+    uint64_t nowNs = virtualTimeUs * 1000;
+    uint64_t byteNs = uint64_t(SERIAL_BITS_PER_BYTE) * 1000000000 / baudRate;
+
+    if (txEndNs <= nowNs)
+        return 0;
+
+    return int((txEndNs - nowNs + byteNs - 1) / byteNs);
+}
+
+int HardwareSerial::read()
+{
+    if (rxHead == rxTail)
+        return -1;
+
+    unsigned char data = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) % SERIAL_RX_BUFFER_SIZE;
+    return data;
+}
+
+/*
+ * Like the arduino core, waits (in virtual time, interrupts keep running) while the transmit buffer is full.
+ * Lines are handed to the host as soon as they are printed, along with the virtual time at which their last
+ * byte will have left the serial port.
+ */
+size_t HardwareSerial::write(const char *data, size_t len)
+{
+    uint64_t byteNs = uint64_t(SERIAL_BITS_PER_BYTE) * 1000000000 / baudRate;
+
+    for (size_t i=0; i<len; i++)
+    {
+        while (getNumTxPending() >= SERIAL_TX_BUFFER_SIZE - 1)
+        {
+            uint64_t freeNs = txEndNs - uint64_t(SERIAL_TX_BUFFER_SIZE - 2) * byteNs;
+            hal_advanceVirtualTimeUs(std::max<uint64_t>(1, (freeNs + 999) / 1000 - virtualTimeUs));
+        }
+        txEndNs = std::max(txEndNs, virtualTimeUs * 1000) + byteNs;
+
+        if (data[i] == '\n')
+        {
+            if (lineHandler)
+                lineHandler(txLine, (txEndNs + 999) / 1000);
+            txLine.clear();
+        }
+        else if (data[i] != '\r')
+        {
+            txLine.push_back(data[i]);
+        }
+    }
+    numBytesWritten += len;
+    return len;
+}
+
+size_t HardwareSerial::printNumber(unsigned long n, int base, bool isNegative)
+{
+    char buf[8 * sizeof(long) + 2];
+    char *str = &buf[sizeof(buf) - 1];
+
+    if (base < 2)
+        base = DEC;
+
+    *str = '\0';
+    do
+    {
+        unsigned long digit = n % base;
+        n /= base;
+        *--str = char(digit < 10 ? digit + '0' : digit + 'A' - 10);
+    } while (n);
+
+    if (isNegative)
+        *--str = '-';
+
+    return print(str);
+}
+
+size_t HardwareSerial::print(const char *str)                   { return write(str, strlen(str));                   }
+size_t HardwareSerial::print(char c)                            { return write(&c, 1);                              }
+size_t HardwareSerial::print(unsigned char n, int base)         { return printNumber(n, base, false);               }
+size_t HardwareSerial::print(unsigned int n, int base)          { return printNumber(n, base, false);               }
+size_t HardwareSerial::print(unsigned long n, int base)         { return printNumber(n, base, false);               }
+size_t HardwareSerial::print(int n, int base)                   { return print(long(n), base);                      }
+
+size_t HardwareSerial::print(long n, int base)
+{
+    // like arduino core, only base 10 numbers are printed with a sign.
+    if ((base == DEC) && (n < 0))
+        return printNumber((unsigned long)(-n), base, true);
+
+    return printNumber((unsigned long)n, base, false);
+}
+
+size_t HardwareSerial::print(double n, int digits)
+{
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return print(buf);
+}
+
+size_t HardwareSerial::println()
+{
+    return write("\r\n", 2);
+}
+
+void HardwareSerial::hostWrite(const char *data, size_t len)
+{
+    for (size_t i=0; i<len; i++)
+    {
+        unsigned int nextHead = (rxHead + 1) % SERIAL_RX_BUFFER_SIZE;
+        if (nextHead == rxTail)
+            break;                  // buffer full
+
+        rxBuffer[rxHead] = (unsigned char)data[i];
+        rxHead = nextHead;
+    }
+}
+
+void HardwareSerial::setLineHandler(std::function<void(const std::string &line, uint64_t sentUs)> handler)
+{
+    lineHandler = handler;
+}
+
+unsigned long HardwareSerial::getNumBytesWritten()
+{
+    return numBytesWritten;
+}
+
+unsigned long HardwareSerial::getBaudRate()
+{
+    return baudRate;
+}
@@ -0,0 +1,27 @@
+#ifndef ARDUINOHAL_H
+#define ARDUINOHAL_H
+
+/*************************************************************************************************
+ Host side controls of the mocked arduino hardware (Arduino.h and AFMotor.h in this directory).
+ *************************************************************************************************/
+
+#include <stdint.h>
+#include <functional>
+
+uint64_t hal_getVirtualTimeUs();
+void hal_setVirtualTimeUs(uint64_t timeUs);
+void hal_advanceVirtualTimeUs(uint64_t durationUs);
+
+void hal_setTimer1CompareAHandler(std::function<void()> handler);
+uint64_t hal_getNextInterruptUs();
+
+void hal_setStepHandler(std::function<void(uint8_t dir, uint8_t style)> handler);
+void hal_notifyStep(uint8_t dir, uint8_t style);
+
+void hal_setPositionHandler(std::function<void(int position, uint64_t timeUs)> handler);
+void hal_reportPosition(int position, unsigned long timeUs);
+
+void hal_setMotionCompletedHandler(std::function<void()> handler);
+void hal_reportMotionCompleted();
+
+#endif // ARDUINOHAL_H
@@ -0,0 +1,176 @@
+#include "firmwarebench.h"
+#include "Arduino.h"
+#include <stdio.h>
+#include <algorithm>
+
+#define BENCH_SETTLE_US         100000      // time given to the sketch between scenarios to finish printing
+#define BENCH_MAX_SERIAL_LOAD   0.94        // fraction of the serial link the sketch may use, in any scenario
+
+
+FirmwareBench::FirmwareBench()
+{
+    //----------------------------------------------------------------
+    // Every scenario starts by stopping the motor ('r'), as arduino can't be power cycled in between.
+    // Step limits are what the sketch achieves with the timer interrupt stepping and the trapezoidal ramp.
+    //
+    // Other limits follow from the serial link (115200 baud, 87 us a byte), not from what was measured:
+    //  - command latency: reply to '?' is 138 bytes (12.0 ms), to 'g' 49 bytes (4.3 ms). A full transmit
+    //    buffer of position lines (63 bytes, 5.5 ms) can be ahead of it. Another 7.5 ms (5 ms for 'g') is
+    //    allowed for reading and executing the command.
+    //  - serial bytes per revolution: a position line is at most 26 bytes, so 400 half steps are 10400
+    //    bytes, plus 1600 for replies. Microstepping at 13 rpm needs more than the link can carry (53169
+    //    bytes in a revolution); positions are skipped, but at most 94% of the link may be used (the
+    //    serial load check, in every scenario), so that replies still get through.
+    //----------------------------------------------------------------
+    scenarios.push_back({ "3 rpm, half steps",
+                          { { 0, "r\ni\n<\n1\n", false }, { 5000000, "?\n", true }, { 12345678, "?\n", true } },
+                          20000000, 2000000,
+                          399, 401, 16, 25000, 12000 });
+
+    scenarios.push_back({ "13 rpm, half steps",
+                          { { 0, "r\ni\n<\n6\n", false }, { 3000000, "?\n", true }, { 7654321, "?\n", true } },
+                          10000000, 2000000,
+                          845, 853, 16, 25000, 12000 });
+
+    scenarios.push_back({ "13 rpm, microsteps",
+                          { { 0, "r\nu\n<\n6\n", false }, { 3000000, "?\n", true }, { 4321987, "?\n", true } },
+                          5000000, 2000000,
+                          3265, 3285, 16, 25000, 50000 });
+
+    scenarios.push_back({ "goto 90 degrees and back",
+                          { { 0, "r\ni\n<\n6\ng90\n", false }, { 8000000, "g270\n", true } },
+                          16000000, 16000000,
+                          400, 400, 0, 15000, 12000 });
+
+    scenarios.push_back({ "goto 30 and 60 degrees",
+                          { { 0, "g30\n", false }, { 8000000, "g60\n", true } },
+                          12000000, 12000000,
+                          167, 167, 0, 15000, 12000 });
+}
+
+/*
+ * One line of the report. Returns 1 if value is out of limits.
+ */
+static int check(const char *what, double value, double minValue, double maxValue, const char *unit)
+{
+    bool isOk = (value >= minValue) && (value <= maxValue);
+
+    printf("    %-28s %10.1f %-6s (limit %.0f .. %.0f)  %s\n", what, value, unit, minValue, maxValue, isOk ? "ok" : "FAILED");
+    return isOk ? 0 : 1;
+}
+
+/*
+ * Run one scenario from the current state of the sketch.
+ */
+BenchResult FirmwareBench::run(const BenchScenario &scenario)
+{
+    FirmwareHost &fw = firmware;
+    BenchResult result;
+
+    uint64_t startUs            = fw.getVirtualTimeUs();
+    uint64_t startSteps         = fw.getNumSteps();
+    uint64_t startSerialBytes   = fw.getNumSerialBytesWritten();
+    int positionsPerRevolution  = fw.getPositionsPerRevolution();
+
+    //----------------------------------------------------------------
+    // Record step intervals once ramp is over, and the distance moved (position wraps every revolution).
+    //----------------------------------------------------------------
+    uint64_t lastStepUs = 0;
+    int lastPosition = fw.getPosition();
+    long distance = 0;
+
+    auto addDistance = [&](int position) {
+        int delta = ((position - lastPosition) % positionsPerRevolution + positionsPerRevolution) % positionsPerRevolution;
+        distance += std::min(delta, positionsPerRevolution - delta);
+        lastPosition = position;
+    };
+
+    fw.setStepHandler([&](uint64_t timeUs) {
+        addDistance(fw.getPosition());      // position of the previous step, as this one is still being taken
+
+        if ((lastStepUs != 0) && (lastStepUs - startUs >= scenario.steadyFromUs))
+        {
+            uint64_t intervalUs = timeUs - lastStepUs;
+
+            if (result.minStepIntervalUs == 0 || intervalUs < result.minStepIntervalUs)
+                result.minStepIntervalUs = intervalUs;
+            result.maxStepIntervalUs = std::max(result.maxStepIntervalUs, intervalUs);
+        }
+        lastStepUs = timeUs;
+    });
+
+    //----------------------------------------------------------------
+    // Latency is the time from posting a command till the last byte of its reply line has been sent.
+    //----------------------------------------------------------------
+    uint64_t latencyFromUs = 0;
+    bool isWaitingForReply = false;
+
+    fw.setSerialLineHandler([&](const std::string &, uint64_t timeUs) {
+        if (isWaitingForReply)
+        {
+            result.maxCommandLatencyUs = std::max(result.maxCommandLatencyUs, timeUs - latencyFromUs);
+            isWaitingForReply = false;
+        }
+    });
+
+    for (const BenchCommand &command : scenario.commands)
+    {
+        fw.runUntil(startUs + command.timeUs);
+
+        latencyFromUs = fw.getVirtualTimeUs();
+        isWaitingForReply = command.measureLatency;
+        fw.postSerial(command.cmd);
+    }
+    fw.runUntil(startUs + scenario.durationUs);
+    addDistance(fw.getPosition());
+
+    uint64_t serialBytes = fw.getNumSerialBytesWritten() - startSerialBytes;
+    double durationSec = (fw.getVirtualTimeUs() - startUs) / 1e6;
+
+    result.numSteps                 = fw.getNumSteps() - startSteps;
+    result.revolutions              = double(distance) / positionsPerRevolution;
+    result.serialBytesPerRevolution = result.revolutions > 0 ? serialBytes / result.revolutions : 0;
+    result.serialLoad               = serialBytes * SERIAL_BITS_PER_BYTE / (double(fw.getSerialBaudRate()) * durationSec);
+
+    fw.setStepHandler(nullptr);
+    fw.setSerialLineHandler(nullptr);
+
+    //----------------------------------------------------------------
+    // Report
+    //----------------------------------------------------------------
+    uint64_t jitterUs = result.maxStepIntervalUs - result.minStepIntervalUs;
+
+    printf("%s\n", scenario.name);
+    result.numFailures += check("steps", result.numSteps, scenario.minSteps, scenario.maxSteps, "");
+    if (scenario.steadyFromUs < scenario.durationUs)
+    {
+        printf("    %-28s %10llu .. %llu us\n", "step interval", (unsigned long long)result.minStepIntervalUs,
+               (unsigned long long)result.maxStepIntervalUs);
+        result.numFailures += check("step jitter", jitterUs, 0, scenario.maxStepJitterUs, "us");
+    }
+    result.numFailures += check("command latency", result.maxCommandLatencyUs, 0, scenario.maxCommandLatencyUs, "us");
+    result.numFailures += check("serial bytes per revolution", result.serialBytesPerRevolution, 0,
+                                scenario.maxSerialBytesPerRevolution, "bytes");
+    result.numFailures += check("serial load", result.serialLoad * 100, 0, BENCH_MAX_SERIAL_LOAD * 100, "%");
+
+    // let the sketch print whatever it has pending before the next scenario starts.
+    fw.runUntil(fw.getVirtualTimeUs() + BENCH_SETTLE_US);
+
+    return result;
+}
+
+/*
+ * Run all scenarios. Returns number of failed checks.
+ */
+int FirmwareBench::runAll()
+{
+    int numFailures = 0;
+
+    firmware.begin();
+
+    for (const BenchScenario &scenario : scenarios)
+        numFailures += run(scenario).numFailures;
+
+    printf("Firmware bench: %s (%d failed checks)\n", numFailures == 0 ? "passed" : "FAILED", numFailures);
+    return numFailures;
+}
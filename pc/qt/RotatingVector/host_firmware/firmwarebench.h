@@ -0,0 +1,66 @@
+#ifndef FIRMWAREBENCH_H
+#define FIRMWAREBENCH_H
+
+#include <stdint.h>
+#include <vector>
+#include "firmwarehost.h"
+
+/*
+ * Command sent to the sketch at the given time (relative to the start of the scenario).
+ */
+struct BenchCommand
+{
+    uint64_t timeUs;
+    const char *cmd;
+    bool measureLatency;        // time till the sketch's reply has been sent counts as command latency
+};
+
+/*
+ * Commands to run and the limits the sketch must stay within.
+ */
+struct BenchScenario
+{
+    const char *name;
+    std::vector<BenchCommand> commands;
+    uint64_t durationUs;
+    uint64_t steadyFromUs;              // step intervals are checked from this time on (ramp is over)
+
+    uint64_t minSteps;
+    uint64_t maxSteps;
+    uint64_t maxStepJitterUs;           // longest minus shortest step interval after 'steadyFromUs'
+    uint64_t maxCommandLatencyUs;
+    uint64_t maxSerialBytesPerRevolution;
+};
+
+struct BenchResult
+{
+    uint64_t numSteps = 0;
+    double revolutions = 0;
+    uint64_t minStepIntervalUs = 0;
+    uint64_t maxStepIntervalUs = 0;
+    uint64_t maxCommandLatencyUs = 0;
+    double serialBytesPerRevolution = 0;
+    double serialLoad = 0;              // fraction of the serial link's capacity used by the sketch
+    int numFailures = 0;
+};
+
+/*************************************************************************************************
+ Runs the arduino SW through scripted command sequences in virtual time and checks step counts,
+ step timing, command latency and serial output volume.  Runs in a fraction of a second, so timing
+ regressions of the sketch show up without arduino or a scope.
+
+ Uses FirmwareHost, so it can't run along with the simulator.
+ *************************************************************************************************/
+class FirmwareBench
+{
+public:
+    FirmwareBench();
+    int runAll();
+    BenchResult run(const BenchScenario &scenario);
+
+private:
+    FirmwareHost firmware;
+    std::vector<BenchScenario> scenarios;
+};
+
+#endif // FIRMWAREBENCH_H
@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Firmware bench: the arduino SW run against the mocked arduino hardware in virtual time, with its step
+# timing, command latency and serial output checked.  Doesn't need Qt libraries, only qmake:
+#
+#   qmake firmwarebench.pro && make && ./firmwarebench
+#
+#-------------------------------------------------
+
+QT       -= core gui
+CONFIG   -= qt app_bundle
+CONFIG   += console c++11
+
+TARGET = firmwarebench
+TEMPLATE = app
+
+SOURCES += \
+    firmwarebenchmain.cpp \
+    arduinohal.cpp \
+    firmwarehost.cpp \
+    firmwarebench.cpp
+
+HEADERS += \
+    Arduino.h \
+    AFMotor.h \
+    arduinohal.h \
+    firmwarehost.h \
+    firmwarebench.h
+
+# The arduino SW is compiled in against the mocked arduino hardware in this directory.
+INCLUDEPATH += \
+    $$PWD \
+    $$PWD/../../../../arduino/stepper_motor_rotating_vector
@@ -0,0 +1,11 @@
+#include "firmwarebench.h"
+
+/*
+ * Firmware bench on its own, without Qt, so that it can run wherever the sketch is built (e.g. CI).
+ * Exit code is the number of failed checks.
+ */
+int main()
+{
+    FirmwareBench bench;
+    return bench.runAll();
+}
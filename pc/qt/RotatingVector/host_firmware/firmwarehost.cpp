@@ -0,0 +1,134 @@
+#include "firmwarehost.h"
+#include "arduinohal.h"
+#include <algorithm>
+
+// Include everything the sketch includes at global scope first. Include guards make the sketch's own
+// includes no-ops inside the namespace below.
+#include "Arduino.h"
+#include "AFMotor.h"
+#include <string.h>
+#include <math.h>
+
+// Sketch hands over its position and completed motions through hal_report*() as well.
+#define HOST_BUILD
+
+namespace firmware {
+#include "stepper_motor_rotating_vector.ino"
+}
+
+
+FirmwareHost::FirmwareHost()
+{
+    hal_setStepHandler([this](uint8_t, uint8_t) {
+        numSteps++;
+        if (stepHandler)
+            stepHandler(hal_getVirtualTimeUs());
+    });
+
+    // sketch hands over the position right before printing its line
+    hal_setPositionHandler([this](int position, uint64_t timeUs) {
+        numPositionLinesToSkip++;
+        if (positionHandler)
+            positionHandler(position, timeUs);
+    });
+
+    Serial.setLineHandler([this](const std::string &line, uint64_t sentUs) {
+        if (numPositionLinesToSkip > 0)
+            numPositionLinesToSkip--;
+        else if (serialLineHandler)
+            serialLineHandler(line, sentUs);
+    });
+
+    hal_setTimer1CompareAHandler(firmware::TIMER1_COMPA_vect);
+}
+
+/*
+ * Same as powering up the arduino.
+ */
+void FirmwareHost::begin()
+{
+    firmware::setup();
+}
+
+/*
+ * loop() has nothing to do till an interrupt records something or till more serial bytes arrive.
+ */
+static bool isLoopIdle()
+{
+    return (Serial.available() == 0) &&
+           (firmware::cmdRingTail == firmware::cmdRingHead) &&
+           (firmware::posRingTail == firmware::posRingHead) &&
+           !firmware::targetReached &&
+           !firmware::halfStepDone;
+}
+
+/*
+ * Keep calling the sketch's loop() until virtual time reaches the given time.  Motor is stepped by the timer
+ * interrupt, which runs when virtual time reaches it.  Each loop() is charged the loop overhead.  When loop()
+ * is idle, time skips to the next interrupt, so loop() reports each step right after it is taken.
+ */
+void FirmwareHost::runUntil(uint64_t timeUs)
+{
+    while (hal_getVirtualTimeUs() < timeUs)
+    {
+        firmware::loop();
+
+        hal_advanceVirtualTimeUs(FIRMWARE_LOOP_OVERHEAD_US);
+
+        if (isLoopIdle())
+        {
+            uint64_t wakeUpTimeUs = std::min(timeUs, hal_getNextInterruptUs());
+
+            if (wakeUpTimeUs > hal_getVirtualTimeUs())
+                hal_advanceVirtualTimeUs(wakeUpTimeUs - hal_getVirtualTimeUs());
+        }
+    }
+}
+
+/*
+ * Send bytes to the sketch as if they were sent by the PC over the serial port.
+ */
+void FirmwareHost::postSerial(const char *data)
+{
+    Serial.hostWrite(data, strlen(data));
+}
+
+/*
+ * Lines printed by the sketch, except the position lines (those are given to the position handler instead).
+ * 'timeUs' is the virtual time at which the last byte of the line has been sent over serial.
+ */
+void FirmwareHost::setSerialLineHandler(std::function<void(const std::string &line, uint64_t timeUs)> handler)
+{
+    serialLineHandler = handler;
+}
+
+/*
+ * Position reported by the sketch, along with the virtual time of the step. Like on arduino, positions are
+ * skipped when serial can't keep up.
+ */
+void FirmwareHost::setPositionHandler(std::function<void(int position, uint64_t timeUs)> handler)
+{
+    positionHandler = handler;
+}
+
+void FirmwareHost::setMotionCompletedHandler(std::function<void()> handler)
+{
+    hal_setMotionCompletedHandler(handler);
+}
+
+/*
+ * Called for every step the motor takes, with the virtual time of the step.
+ */
+void FirmwareHost::setStepHandler(std::function<void(uint64_t timeUs)> handler)
+{
+    stepHandler = handler;
+}
+
+uint64_t FirmwareHost::getVirtualTimeUs()   {   return hal_getVirtualTimeUs();          }
+uint64_t FirmwareHost::getNumSteps()        {   return numSteps;                        }
+uint64_t FirmwareHost::getNumSerialBytesWritten()   {   return Serial.getNumBytesWritten(); }
+unsigned long FirmwareHost::getSerialBaudRate()     {   return Serial.getBaudRate();        }
+int FirmwareHost::getPosition()             {   return firmware::position;              }
+int FirmwareHost::getPositionsPerRevolution()   {   return POSITIONS_PER_REVOLUTION;    }
+bool FirmwareHost::isMotorRunning()         {   return firmware::runMotor;              }
+bool FirmwareHost::isCounterClockwise()     {   return firmware::isCounterClockwise;    }
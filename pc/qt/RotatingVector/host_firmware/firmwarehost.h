@@ -0,0 +1,47 @@
+#ifndef FIRMWAREHOST_H
+#define FIRMWAREHOST_H
+
+#include <stdint.h>
+#include <string>
+#include <functional>
+
+#define FIRMWARE_LOOP_OVERHEAD_US       10          // virtual time charged for each iteration of the sketch's loop()
+
+/*************************************************************************************************
+ Runs the actual arduino SW (stepper_motor_rotating_vector.ino) on the PC against the mocked
+ arduino hardware in this directory.  Everything happens in virtual time, so the sketch can run
+ much faster (or slower) than real time.
+
+ The sketch keeps its state in global variables, hence there can only be one instance of this class.
+ *************************************************************************************************/
+class FirmwareHost
+{
+public:
+    FirmwareHost();
+    void begin();
+    void runUntil(uint64_t timeUs);
+    void postSerial(const char *data);
+
+    void setSerialLineHandler(std::function<void(const std::string &line, uint64_t timeUs)> handler);
+    void setPositionHandler(std::function<void(int position, uint64_t timeUs)> handler);
+    void setMotionCompletedHandler(std::function<void()> handler);
+    void setStepHandler(std::function<void(uint64_t timeUs)> handler);
+
+    uint64_t getVirtualTimeUs();
+    uint64_t getNumSteps();
+    uint64_t getNumSerialBytesWritten();
+    unsigned long getSerialBaudRate();
+    int getPosition();
+    int getPositionsPerRevolution();
+    bool isMotorRunning();
+    bool isCounterClockwise();
+
+private:
+    uint64_t numSteps = 0;
+    unsigned int numPositionLinesToSkip = 0;
+    std::function<void(const std::string &line, uint64_t timeUs)> serialLineHandler;
+    std::function<void(int position, uint64_t timeUs)> positionHandler;
+    std::function<void(uint64_t timeUs)> stepHandler;
+};
+
+#endif // FIRMWAREHOST_H
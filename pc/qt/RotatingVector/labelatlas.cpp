@@ -0,0 +1,331 @@
+#include "labelatlas.h"
+#include <QFont>
+#include <QFontMetrics>
+#include <algorithm>
+#include <tuple>
+
+#define LABEL_PADDING           1       // device pixels around each label in the atlas
+
+struct OrdinateCaption
+{
+    int key;
+    const char *text;
+};
+
+static const OrdinateCaption ordinateCaptions[] = {
+    {  1000, "+1.0"   }, {  866, "+0.866" }, {  707, "+0.707" }, {  500, "+0.5" },
+    { -1000, "-1.0"   }, { -866, "-0.866" }, { -707, "-0.707" }, { -500, "-0.5" },
+};
+
+static const char *angleReadoutGlyphs = "0123456789-°";
+
+
+static std::tuple<int, int> getRadianAngleDisplayWidthAndHeight(int angleInDegree, int w1, int h1)
+{
+    // w1 = single character width in current font
+    // h1 = single character height in current font
+
+    switch (angleInDegree)
+    {
+    case 0: return std::make_tuple(w1, h1);              // 0
+
+    case 30: return std::make_tuple(w1, 2 * h1);             // 𝛑/6
+    case 45: return std::make_tuple(w1, 2 * h1);             // 𝛑/4
+    case 60: return std::make_tuple(2 * w1, 2 * h1);             // 2𝛑/6
+
+    case 90: return std::make_tuple(w1, 2 * h1);             // 𝛑/2
+
+    case 120: return std::make_tuple(2 * w1, 2 * h1);        // 4𝛑/6
+    case 135: return std::make_tuple(2 * w1, 2 * h1);        // 3𝛑/4
+    case 150: return std::make_tuple(2 * w1, 2 * h1);        // 5𝛑/6
+
+    case 180: return std::make_tuple(w1, h1);            // 𝛑
+
+    case 210: return std::make_tuple(2 * w1, 2 * h1);        // 7𝛑/6
+    case 225: return std::make_tuple(2 * w1, 2 * h1);        // 5𝛑/4
+    case 240: return std::make_tuple(2 * w1, 2 * h1);        // 8𝛑/6
+
+    case 270: return std::make_tuple(2 * w1, 2 * h1);        // 3𝛑/4
+
+    case 300: return std::make_tuple(3 * w1, 2 * h1);        // 10𝛑/6
+    case 315: return std::make_tuple(2 * w1, 2 * h1);        // 7𝛑/4
+    case 330: return std::make_tuple(3 * w1, 2 * h1);        // 11𝛑/6
+
+
+    case 360: return std::make_tuple(w1, h1);            // 0
+    }
+
+    return std::make_tuple(0, 0);
+}
+
+// w1 = single character width
+static void drawRadianAngle(QPainter *p, int x, int y, int angleInDegree, int w1)
+{
+    int denominator = 1;
+    int multiplier = 1;
+    int h1 = p->font().pixelSize();
+
+    switch (angleInDegree)
+    {
+        case 0:     multiplier = 1;     denominator = 1;    break;
+
+        case 30:    multiplier = 1;     denominator = 6;    break;
+        case 45:    multiplier = 1;     denominator = 4;    break;
+        case 60:    multiplier = 2;     denominator = 6;    break;
+        case 90:    multiplier = 1;     denominator = 2;    break;
+
+        case 120:   multiplier = 4;     denominator = 6;    break;
+        case 135:   multiplier = 3;     denominator = 4;    break;
+        case 150:   multiplier = 5;     denominator = 6;    break;
+        case 180:   multiplier = 1;     denominator = 1;    break;
+
+        case 210:   multiplier = 7;     denominator = 6;    break;
+        case 225:   multiplier = 5;     denominator = 4;    break;
+        case 240:   multiplier = 8;     denominator = 6;    break;
+        case 270:   multiplier = 3;     denominator = 2;    break;
+
+        case 300:   multiplier = 10;    denominator = 6;    break;
+        case 315:   multiplier = 7;     denominator = 4;    break;
+        case 330:   multiplier = 11;    denominator = 6;    break;
+        case 360:   multiplier = 1;     denominator = 1;    break;
+    }
+
+    switch (angleInDegree)
+    {
+        case 0:     p->drawText(x, y, "0");     break;
+        case 180:   p->drawText(x, y, "𝛑");     break;
+        default:
+            if (multiplier != 1)
+            {
+                int ym = y;                 // y value of multipler is different if denominator is not 1.
+                if (denominator != 1)
+                    ym += h1 / 2 + 2;
+
+                QString str = QString::number(multiplier);
+                p->drawText(x, ym, str);
+
+                QFontMetrics fm(p->font());
+                x += fm.horizontalAdvance(str) + 2;
+            }
+
+            p->drawText(x-1, y, "𝛑");
+
+            if (denominator != 1)
+            {
+                p->drawLine(x - 2,
+                            y + 3,
+                            x + 12,
+                            y + 3);
+                y += h1 + 1;
+                p->drawText(x, y, QString::number(denominator));
+            }
+            break;
+    }
+}
+
+/*
+ * Render all labels again if device pixel ratio has changed (or on first call).
+ */
+void LabelAtlas::update(qreal devicePixelRatio)
+{
+    if (devicePixelRatio == this->devicePixelRatio)
+        return;
+
+    this->devicePixelRatio = devicePixelRatio;
+    entries.clear();
+
+    QColor labelColor(50, 50, 50);
+
+    //----------------------------------------------------------------
+    // Angle marks
+    //----------------------------------------------------------------
+    QFont angleFont;
+    angleFont.setPixelSize(ANGLE_LABEL_FONT_PIXEL_SIZE);
+    QFontMetrics angleFm(angleFont);
+    int w1 = angleFm.horizontalAdvance("O");        // width of 1 dummy character
+
+    for (int angle=-360; angle<=360; angle+=15)
+    {
+        QString str = QString::number(angle);
+        add(ANGLE_IN_DEGREES, angle, ANGLE_LABEL_FONT_PIXEL_SIZE, labelColor, angleFm.horizontalAdvance(str),
+            [&](QPainter *p) { p->drawText(0, 0, str); });
+
+        int w = std::get<0>(getRadianAngleDisplayWidthAndHeight(angle, w1, ANGLE_LABEL_FONT_PIXEL_SIZE));
+        add(ANGLE_IN_RADIANS, angle, ANGLE_LABEL_FONT_PIXEL_SIZE, labelColor, w,
+            [&](QPainter *p) { drawRadianAngle(p, 0, 0, angle, w1); });
+    }
+
+    //----------------------------------------------------------------
+    // Ordinate captions
+    //----------------------------------------------------------------
+    QFont captionFont;
+    captionFont.setPixelSize(ORDINATE_CAPTION_FONT_PIXEL_SIZE);
+    QFontMetrics captionFm(captionFont);
+
+    for (const OrdinateCaption &caption : ordinateCaptions)
+    {
+        add(ORDINATE_CAPTION, caption.key, ORDINATE_CAPTION_FONT_PIXEL_SIZE, labelColor,
+            captionFm.horizontalAdvance(caption.text),
+            [&](QPainter *p) { p->drawText(0, 0, caption.text); });
+    }
+
+    //----------------------------------------------------------------
+    // Angle readout
+    //----------------------------------------------------------------
+    QFont readoutFont;
+    readoutFont.setPixelSize(ANGLE_READOUT_FONT_PIXEL_SIZE);
+    QFontMetrics readoutFm(readoutFont);
+
+    for (QChar c : QString(angleReadoutGlyphs))
+    {
+        add(ANGLE_READOUT_GLYPH, c.unicode(), ANGLE_READOUT_FONT_PIXEL_SIZE, Qt::black, readoutFm.horizontalAdvance(c),
+            [&](QPainter *p) { p->drawText(0, 0, QString(c)); });
+    }
+
+    pack();
+}
+
+/*
+ * Render one label into an image of its own, cropped to the pixels it has drawn.  drawLabel draws the
+ * label at 0, 0 as if it were drawing it in the widget.
+ */
+void LabelAtlas::add(Group group, int key, int fontPixelSize, QColor color, int width, std::function<void(QPainter*)> drawLabel)
+{
+    // big enough for the label with multiplier, fraction bar and denominator around 0, 0.
+    int size = 8 * fontPixelSize;
+    QPoint origin(2 * fontPixelSize, 4 * fontPixelSize);
+
+    QImage image(int(size * devicePixelRatio), int(size * devicePixelRatio), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.fill(Qt::transparent);
+    {
+        QFont font;
+        font.setPixelSize(fontPixelSize);
+
+        QPen pen(color);
+        pen.setWidth(2);
+
+        QPainter p(&image);
+        p.setFont(font);
+        p.setPen(pen);
+        p.translate(origin);
+        drawLabel(&p);
+    }
+
+    //----------------------------------------------------------------
+    // Crop to the drawn pixels
+    //----------------------------------------------------------------
+    int left = image.width(), right = -1;
+    int top = image.height(), bottom = -1;
+
+    for (int y=0; y<image.height(); y++)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        for (int x=0; x<image.width(); x++)
+        {
+            if (qAlpha(line[x]) != 0)
+            {
+                left = std::min(left, x);
+                right = std::max(right, x);
+                top = std::min(top, y);
+                bottom = std::max(bottom, y);
+            }
+        }
+    }
+
+    RenderedLabel label;
+    label.groupAndKey = std::make_pair(int(group), key);
+    label.entry.width = width;
+
+    if (right < 0)      // nothing drawn (e.g. no glyph in font)
+    {
+        label.entry.offset = QPointF(0, 0);
+    }
+    else
+    {
+        QRect crop(left - LABEL_PADDING, top - LABEL_PADDING,
+                   right - left + 1 + 2 * LABEL_PADDING, bottom - top + 1 + 2 * LABEL_PADDING);
+
+        label.image = image.copy(crop);         // area outside of the image is transparent
+        label.image.setDevicePixelRatio(1);     // copied into atlas pixel for pixel
+        label.entry.offset = QPointF(crop.left() / devicePixelRatio - origin.x(), crop.top() / devicePixelRatio - origin.y());
+    }
+    renderedLabels.push_back(label);
+}
+
+/*
+ * Place rendered labels in rows, tallest first, and copy them into the atlas.
+ */
+void LabelAtlas::pack()
+{
+    std::sort(renderedLabels.begin(), renderedLabels.end(), [](const RenderedLabel &a, const RenderedLabel &b) {
+        return a.image.height() > b.image.height();
+    });
+
+    int x = 0, y = 0, rowHeight = 0;
+    for (RenderedLabel &label : renderedLabels)
+    {
+        if (x + label.image.width() > LABEL_ATLAS_WIDTH)
+        {
+            x = 0;
+            y += rowHeight;
+            rowHeight = 0;
+        }
+        label.entry.source = QRect(x, y, label.image.width(), label.image.height());
+        x += label.image.width();
+        rowHeight = std::max(rowHeight, label.image.height());
+    }
+
+    atlas = QImage(LABEL_ATLAS_WIDTH, std::max(1, y + rowHeight), QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+    {
+        QPainter p(&atlas);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+
+        for (const RenderedLabel &label : renderedLabels)
+        {
+            if (!label.image.isNull())
+                p.drawImage(label.entry.source.topLeft(), label.image);
+            entries[label.groupAndKey] = label.entry;
+        }
+    }
+    renderedLabels.clear();
+}
+
+void LabelAtlas::draw(QPainter *p, int x, int y, Group group, int key) const
+{
+    auto it = entries.find(std::make_pair(int(group), key));
+    if ((it == entries.end()) || it->second.source.isEmpty())
+        return;
+
+    const Entry &entry = it->second;
+    QRectF target(x + entry.offset.x(),
+                  y + entry.offset.y(),
+                  entry.source.width() / devicePixelRatio,
+                  entry.source.height() / devicePixelRatio);
+
+    p->drawImage(target, atlas, entry.source);
+}
+
+void LabelAtlas::drawString(QPainter *p, int x, int y, Group group, const QString &text) const
+{
+    for (QChar c : text)
+    {
+        draw(p, x, y, group, c.unicode());
+        x += getWidth(group, c.unicode());
+    }
+}
+
+int LabelAtlas::getWidth(Group group, int key) const
+{
+    auto it = entries.find(std::make_pair(int(group), key));
+    return (it == entries.end()) ? 0 : it->second.width;
+}
+
+int LabelAtlas::getStringWidth(Group group, const QString &text) const
+{
+    int width = 0;
+    for (QChar c : text)
+        width += getWidth(group, c.unicode());
+    return width;
+}
@@ -0,0 +1,73 @@
+#ifndef LABELATLAS_H
+#define LABELATLAS_H
+
+#include <QImage>
+#include <QPainter>
+#include <QString>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#define ANGLE_LABEL_FONT_PIXEL_SIZE         20
+#define ORDINATE_CAPTION_FONT_PIXEL_SIZE    15
+#define ANGLE_READOUT_FONT_PIXEL_SIZE       40
+#define LABEL_ATLAS_WIDTH                   1024        // device pixels
+
+
+/*************************************************************************************************
+ Every caption the render widget draws, rendered once into a single image at the device pixel
+ ratio of the widget.  Drawing a label is then a blit, with no text laid out in the frame.
+
+    - angle marks on the waves, in degrees and in radians (fractions of pi), for multiples of 15
+      degrees in -360..360.
+    - captions of the important ordinates (+1.0, +0.866 ... -1.0).
+    - glyphs of the angle readout under the vector (digits, '-' and degree sign).
+
+ Text color is part of the image. Painter's opacity and transform apply as for any image.
+ *************************************************************************************************/
+class LabelAtlas
+{
+public:
+    enum Group
+    {
+        ANGLE_IN_DEGREES,           // key is the angle
+        ANGLE_IN_RADIANS,           // key is the angle
+        ORDINATE_CAPTION,           // key is the ordinate * 1000 (e.g. 866 for +0.866)
+        ANGLE_READOUT_GLYPH         // key is the character
+    };
+
+    void update(qreal devicePixelRatio);
+
+    // x, y is where QPainter::drawText() would have drawn the label.
+    void draw(QPainter *p, int x, int y, Group group, int key) const;
+    void drawString(QPainter *p, int x, int y, Group group, const QString &text) const;
+
+    int getWidth(Group group, int key) const;
+    int getStringWidth(Group group, const QString &text) const;
+
+private:
+    struct Entry
+    {
+        QRect source;               // in atlas, device pixels
+        QPointF offset;             // of the top left of source from the point label is drawn at, logical pixels
+        int width;                  // advance of the label, logical pixels
+    };
+
+    struct RenderedLabel
+    {
+        std::pair<int, int> groupAndKey;
+        QImage image;
+        Entry entry;
+    };
+
+    void add(Group group, int key, int fontPixelSize, QColor color, int width, std::function<void(QPainter*)> drawLabel);
+    void pack();
+
+    qreal devicePixelRatio = 0;
+    QImage atlas;
+    std::map<std::pair<int, int>, Entry> entries;
+    std::vector<RenderedLabel> renderedLabels;      // only while building
+};
+
+#endif // LABELATLAS_H
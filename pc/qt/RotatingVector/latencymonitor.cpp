@@ -0,0 +1,56 @@
+#include "latencymonitor.h"
+
+void LatencyMonitor::reset()
+{
+    hasOffset = false;
+    lastReceivedTimeUs = 0;
+    presentedReceivedTimeUs = 0;
+    serialLatencyUs = 0;
+    presentationLatencyUs = 0;
+}
+
+/*
+ * Returns the time in PC clock at which the vector was at the sample's position.
+ */
+qint64 LatencyMonitor::addSample(const AngleSample &sample)
+{
+    qint64 offsetUs = sample.receivedTimeUs - sample.transferTimeUs - sample.timestampUs;
+
+    if (!hasOffset || (offsetUs < clockOffsetUs))
+    {
+        clockOffsetUs = offsetUs;
+        hasOffset = true;
+    }
+    else
+    {
+        clockOffsetUs += (sample.receivedTimeUs - lastReceivedTimeUs) * LATENCY_OFFSET_RELAX_PPM / 1000000;
+        clockOffsetUs = qMin(clockOffsetUs, offsetUs);
+    }
+    lastReceivedTimeUs = sample.receivedTimeUs;
+
+    qint64 positionTimeUs = sample.timestampUs + clockOffsetUs;
+
+    serialLatencyUs += LATENCY_SMOOTHING * ((sample.receivedTimeUs - positionTimeUs) - serialLatencyUs);
+
+    return positionTimeUs;
+}
+
+/*
+ * A frame was drawn between the given times, and will be visible at 'presentationTimeUs'.  Presentation latency
+ * is measured if the frame is the first to use the last sample received (samples arriving while it was drawn
+ * are left to the next frame).
+ */
+void LatencyMonitor::addFrame(qint64 frameStartUs, qint64 frameEndUs, qint64 presentationTimeUs)
+{
+    renderTimeUs += LATENCY_SMOOTHING * ((frameEndUs - frameStartUs) - renderTimeUs);
+
+    if (hasOffset && (lastReceivedTimeUs > presentedReceivedTimeUs) && (lastReceivedTimeUs <= frameStartUs))
+    {
+        presentationLatencyUs += LATENCY_SMOOTHING * ((presentationTimeUs - lastReceivedTimeUs) - presentationLatencyUs);
+        presentedReceivedTimeUs = lastReceivedTimeUs;
+    }
+}
+
+qint64 LatencyMonitor::getRenderTimeUs()            {   return qint64(renderTimeUs);                                    }
+double LatencyMonitor::getSerialLatencyMs()         {   return serialLatencyUs / 1000.0;                                }
+double LatencyMonitor::getPresentationLatencyMs()   {   return presentationLatencyUs / 1000.0;                          }
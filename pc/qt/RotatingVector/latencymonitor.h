@@ -0,0 +1,43 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include <QtGlobal>
+#include "samplesink.h"
+
+#define LATENCY_OFFSET_RELAX_PPM        5000        // how fast clock offset may drift up (arduino uses a ceramic resonator)
+#define LATENCY_SMOOTHING               0.05        // how fast displayed latencies follow the measured ones
+
+/*************************************************************************************************
+ Estimates end to end latency between the position of the vector and the frame showing it:
+
+    - serial latency: from the time arduino reached a position to the time PC received it.
+    - presentation latency: from the time PC received a position to the time a frame using it is presented.
+      Only the first frame drawn after a position is received counts, so it doesn't grow while the vector
+      is stopped or arduino is silent.
+
+ Arduino and PC clocks are not synchronized.  Their offset is estimated as the lower envelope of
+ (receipt time - transfer time - arduino time), i.e. from the fastest transfers seen.  The envelope is
+ allowed to rise slowly to follow clock drift.
+ *************************************************************************************************/
+class LatencyMonitor
+{
+public:
+    void reset();
+    qint64 addSample(const AngleSample &sample);
+    void addFrame(qint64 frameStartUs, qint64 frameEndUs, qint64 presentationTimeUs);
+    qint64 getRenderTimeUs();
+    double getSerialLatencyMs();
+    double getPresentationLatencyMs();
+
+private:
+    bool hasOffset = false;
+    qint64 clockOffsetUs = 0;           // PC clock - sample source clock
+    qint64 lastReceivedTimeUs = 0;
+    qint64 presentedReceivedTimeUs = 0; // receipt time of the last sample whose presentation was measured
+
+    double serialLatencyUs = 0;
+    double presentationLatencyUs = 0;
+    double renderTimeUs = 0;
+};
+
+#endif // LATENCYMONITOR_H
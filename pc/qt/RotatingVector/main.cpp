@@ -1,19 +1,55 @@
-#include "mainwindow.h"
-#include "controlwindow.h"
-#include <QApplication>
-
-int main(int argc, char *argv[])
-{
-    QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
-
-    QApplication a(argc, argv);
-    MainWindow w;
-    ControlWindow cw(&w, &w);
-
-    w.setControlWindow(&cw);        // give control window handle to main window
-
-    w.show();
-    cw.show();
-
-    return a.exec();
-}
+#include "mainwindow.h"
+#include "controlwindow.h"
+#include "renderwidget.h"
+#include "wavebench.h"
+#include <QApplication>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    // --export <file.y4m | file.rgb | directory> [--export-fps <n>] [--export-frames <n>] [--offscreen]
+    QString exportPath;
+    int exportFramesPerSecond = 0;
+    int exportMaxFrames = 0;
+    bool isExportOffscreen = false;
+
+    for (int i=1; i<argc; i++)
+    {
+        // time drawing the waves with the painter and with the wave rasterizer, and exit.
+        if (strcmp(argv[i], "--wave-bench") == 0)
+        {
+            WaveBench bench;
+            return bench.runAll();
+        }
+
+        if ((strcmp(argv[i], "--export") == 0) && (i + 1 < argc))
+            exportPath = argv[++i];
+        else if ((strcmp(argv[i], "--export-fps") == 0) && (i + 1 < argc))
+            exportFramesPerSecond = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--export-frames") == 0) && (i + 1 < argc))
+            exportMaxFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--offscreen") == 0)
+            isExportOffscreen = true;
+    }
+
+    QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    // e.g. 150% on a projector is a pixel ratio of 1.5, not rounded to 2, so drawings keep their size on any display.
+    QGuiApplication::setHighDpiScaleFactorRoundingPolicy(Qt::HighDpiScaleFactorRoundingPolicy::PassThrough);
+#endif
+
+    QApplication a(argc, argv);
+    MainWindow w;
+    ControlWindow cw(&w, &w);
+
+    w.setControlWindow(&cw);        // give control window handle to main window
+
+    if (!exportPath.isEmpty())
+        w.renderWidget->startExportWhenShown(exportPath, exportFramesPerSecond, isExportOffscreen, exportMaxFrames);
+
+    w.show();
+    cw.show();
+
+    return a.exec();
+}
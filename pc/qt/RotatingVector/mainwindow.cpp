@@ -1,208 +1,197 @@
-#include "mainwindow.h"
-#include "renderwidget.h"
-#include "controlwindow.h"
-#include "ui_mainwindow.h"
-#include "ui_controlwindow.h"
-#include "aboutdialog.h"
-#include <stdio.h>
-#include <iostream>
-#include <QPen>
-#include <QPainter>
-#include <math.h>
-#include <QDir>
-#include <QMessageBox>
-#include <QKeyEvent>
-
-MainWindow::MainWindow(QWidget *parent) :
-    QMainWindow(parent),
-    ui(new Ui::MainWindow)
-{
-    //---------------------------------------------------------------------------------
-    // Following values are set to I don't have to click checkboxes everytime I start the app for testing.
-    // Comment these values for actual demonstration.
-    showVerticalProjectionBox = true;
-    showHorizontalProjectionBox = true;
-
-    drawVerticalShadow = true;
-    drawHorizontalShadow = true;
-
-    drawVerticalProjectionTipCircle = true;
-    drawHorizontalProjectionTipCircle = true;
-
-    drawVerticalProjectionDottedLine = true;
-    drawHorizontalProjectionDottedLine = true;
-
-    showSinOnXAxis = true;
-    showCosOnYAxis = true;
-    showCosOnXAxis = true;
-
-    drawAngleArc = true;
-    showAnglesOnXAndYAxis = true;
-//    show30And60Angles = true;
-    //---------------------------------------------------------------------------------
-
-    setbuf(stdout, nullptr);
-    ui->setupUi(this);
-    QMainWindow::showMaximized();
-    setWindowTitle("Rotating Vector");
-
-    renderWidget = new RenderWidget(ui->topWidget, this);
-    renderWidget->setObjectName(QStringLiteral("renderWidget"));
-    QSizePolicy sizePolicy5(QSizePolicy::Preferred, QSizePolicy::Minimum);
-    sizePolicy5.setHorizontalStretch(0);
-    sizePolicy5.setVerticalStretch(1);
-    sizePolicy5.setHeightForWidth(renderWidget->sizePolicy().hasHeightForWidth());
-    renderWidget->setSizePolicy(sizePolicy5);
-    renderWidget->setMinimumSize(QSize(0, 400));
-    renderWidget->setStyleSheet(QStringLiteral("background: green"));
-
-    ui->topWidgetLayout->addWidget(renderWidget);
-
-
-    //-------------- Connect signals to slots ------------------
-    connect(serial, &QSerialPort::readyRead, this, &MainWindow::readSerialData);
-
-
-    // ----------------- Serial port -----------------
-    serial->setPortName("COM3");
-    serial->setBaudRate(115200);
-    serial->setDataBits(QSerialPort::DataBits::Data8);
-    if (serial->open(QIODevice::ReadWrite))
-    {
-        printf("Serial port opened successfully\n");
-    }
-
-    arduinoSimulator = new ArduinoSimulator(this, this);
-
-    printf("Current Dir: %s\n", QDir::currentPath().toStdString().c_str());
-    fflush(stdout);
-
-    oneTimeTimer.setSingleShot(true);
-    connect(&oneTimeTimer, SIGNAL(timeout()), this, SLOT(oneTimeTimerHandler()));
-    oneTimeTimer.start(500);
-
-}
-
-
-
-MainWindow::~MainWindow()
-{
-    delete ui;
-}
-
-void MainWindow::oneTimeTimerHandler()
-{
-//    cw->setLowestSpeed();
-//    cw->continueVectorAndUnpauseTime();
-}
-
-void MainWindow::setControlWindow(ControlWindow *cw)
-{
-    this->cw = cw;
-    showControlWindowCentered();
-}
-
-void MainWindow::renderWidgetPaintEvent()
-{
-    if (!useArduino)
-    {
-        arduinoSimulator->tick();
-    }
-}
-
-void MainWindow::keyPressEvent(QKeyEvent *event)
-{
-    if (event->key() == Qt::Key_Space)
-    {
-        if (event->modifiers() & Qt::ControlModifier)
-            cw->continueVectorAndUnpauseTime();
-        else
-            cw->pauseVectorAndTime();
-    }
-}
-
-
-void MainWindow::readSerialData()
-{
-    const QByteArray data = serial->readAll();
-    serialData->append(data);
-
-    // did we get a comple line?
-    if (serialData->contains('\n'))
-    {
-        // print the line
-        int newlineIndex = serialData->indexOf('\n');
-        QByteArray line = serialData->left(newlineIndex);
-
-        // we read the serial data unconditionally, but process it only if 'use arduino' is selected.
-        if (useArduino)
-        {
-            processSerialLine(line);
-        }
-
-        serialData->remove(0, newlineIndex+1);
-    }
-}
-
-
-void MainWindow::processSerialLine(QByteArray line)
-{
-    QRegularExpression re("(\\d+\\.\\d+)[ ]+(\\d+)");
-
-    //printf("%s", line.data());
-
-    QRegularExpressionMatch match = re.match(line.data());
-
-
-//        printf("regex match result contains %d results. pos = %d\n", list.size(), pos);
-    if (match.hasMatch())
-    {
-        QString list = match.captured(0);
-        if (list.size() == 3)
-        {
-            QString qstr;
-
-            // Extract angle
-            qstr = list.at(1);
-            curAngleInDegrees = qstr.toDouble();
-
-            //printf("Angle: %.2f\n", double(curAngleInDegrees));
-            cw->ui->curAngle_le->setText(qstr.toLocal8Bit().constData());       // set current angle in GUI
-
-            if (useArduino)
-                curAngleInDegrees += cw->ui->angleAdvanceOffset_sb->value();
-
-            curAngleInRadians = curAngleInDegrees * M_PI / 180;
-            curHeight = int(amplitude * sin(curAngleInRadians));
-            curWidth  = int(amplitude * cos(curAngleInRadians));
-
-            // Extract half steps
-            qstr = list.at(2);
-            halfSteps = qstr.toInt();
-            //printf("Half steps: %d\n", halfSteps);
-            cw->ui->curHalfSteps_le->setText(qstr.toLocal8Bit().constData());
-        }
-    }
-    //printf("\n");
-}
-
-void MainWindow::showControlWindowCentered()
-{
-    cw->show();
-    cw->move(200, 50);
-}
-
-void MainWindow::on_actionControl_Panel_triggered()
-{
-    showControlWindowCentered();
-}
-
-void MainWindow::on_actionAbout_triggered()
-{
-    AboutDialog aboutDialog;
-    aboutDialog.setModal(true);
-    aboutDialog.exec();
-
-//    QMessageBox messageBox;
-//    messageBox.about(this, "About Rotating Vector", "Version 0.1.1\nAuthor: Abhir Joshi");
-}
+#include "mainwindow.h"
+#include "renderwidget.h"
+#include "controlwindow.h"
+#include "ui_mainwindow.h"
+#include "ui_controlwindow.h"
+#include "aboutdialog.h"
+#include <stdio.h>
+#include <iostream>
+#include <QPen>
+#include <QPainter>
+#include <math.h>
+#include <QDir>
+#include <QMessageBox>
+#include <QKeyEvent>
+
+MainWindow::MainWindow(QWidget *parent) :
+    QMainWindow(parent),
+    ui(new Ui::MainWindow)
+{
+    //---------------------------------------------------------------------------------
+    // Following values are set to I don't have to click checkboxes everytime I start the app for testing.
+    // Comment these values for actual demonstration.
+    showVerticalProjectionBox = true;
+    showHorizontalProjectionBox = true;
+
+    drawVerticalShadow = true;
+    drawHorizontalShadow = true;
+
+    drawVerticalProjectionTipCircle = true;
+    drawHorizontalProjectionTipCircle = true;
+
+    drawVerticalProjectionDottedLine = true;
+    drawHorizontalProjectionDottedLine = true;
+
+    showSinOnXAxis = true;
+    showCosOnYAxis = true;
+    showCosOnXAxis = true;
+
+    drawAngleArc = true;
+    showAnglesOnXAndYAxis = true;
+//    show30And60Angles = true;
+    //---------------------------------------------------------------------------------
+
+    setbuf(stdout, nullptr);
+    ui->setupUi(this);
+    QMainWindow::showMaximized();
+    setWindowTitle("Rotating Vector");
+
+    renderWidget = new RenderWidget(ui->topWidget, this);
+    renderWidget->setObjectName(QStringLiteral("renderWidget"));
+    QSizePolicy sizePolicy5(QSizePolicy::Preferred, QSizePolicy::Minimum);
+    sizePolicy5.setHorizontalStretch(0);
+    sizePolicy5.setVerticalStretch(1);
+    sizePolicy5.setHeightForWidth(renderWidget->sizePolicy().hasHeightForWidth());
+    renderWidget->setSizePolicy(sizePolicy5);
+    renderWidget->setMinimumSize(QSize(0, 400));
+    renderWidget->setStyleSheet(QStringLiteral("background: green"));
+
+    ui->topWidgetLayout->addWidget(renderWidget);
+
+
+    //-------------- Connect signals to slots ------------------
+    connect(serial, &QSerialPort::readyRead, this, &MainWindow::readSerialData);
+
+
+    // ----------------- Serial port -----------------
+    serial->setPortName("COM3");
+    serial->setBaudRate(SERIAL_BAUD_RATE);
+    serial->setDataBits(QSerialPort::DataBits::Data8);
+    if (serial->open(QIODevice::ReadWrite))
+    {
+        printf("Serial port opened successfully\n");
+    }
+
+    arduinoSimulator = new ArduinoSimulator(this, this);
+    arduinoSimulator->setTimeScale(simulatorTimeScale);
+
+    printf("Current Dir: %s\n", QDir::currentPath().toStdString().c_str());
+    fflush(stdout);
+
+    oneTimeTimer.setSingleShot(true);
+    connect(&oneTimeTimer, SIGNAL(timeout()), this, SLOT(oneTimeTimerHandler()));
+    oneTimeTimer.start(500);
+
+}
+
+
+
+MainWindow::~MainWindow()
+{
+    delete ui;
+}
+
+void MainWindow::oneTimeTimerHandler()
+{
+//    cw->setLowestSpeed();
+//    cw->continueVectorAndUnpauseTime();
+}
+
+void MainWindow::setControlWindow(ControlWindow *cw)
+{
+    this->cw = cw;
+    showControlWindowCentered();
+}
+
+void MainWindow::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Space)
+    {
+        if (event->modifiers() & Qt::ControlModifier)
+            cw->continueVectorAndUnpauseTime();
+        else
+            cw->pauseVectorAndTime();
+    }
+}
+
+
+void MainWindow::readSerialData()
+{
+    const QByteArray data = serial->readAll();
+
+    // we read the serial data unconditionally, but process it only if 'use arduino' is selected.
+    if (useArduino)
+        serialDecoder.feed(data);
+    else
+        serialDecoder.reset();
+}
+
+
+/*
+ * Position of the vector from arduino or simulator. Drawing doesn't use it directly; it goes through the
+ * angle estimator, which predicts the angle at the time each frame is presented.
+ */
+void MainWindow::pushSample(const AngleSample &sample)
+{
+    qint64 positionTimeUs = latencyMonitor.addSample(sample);
+
+    angleEstimator.addSample(positionTimeUs, sample.angleInDegrees);
+
+    cw->ui->curAngle_le->setText(QString::number(sample.angleInDegrees, 'f', 2));       // set current angle in GUI
+
+    position = sample.position;
+    cw->ui->curPosition_le->setText(QString::number(position));
+}
+
+/*
+ * Prediction of the angle follows the same speed ramps as the motor.
+ */
+void MainWindow::setMotionProfile(const MotionProfile &profile)
+{
+    angleEstimator.setMaxAcceleration(profile.accelerationDegPerSec2);
+}
+
+/*
+ * Set the angle to be drawn in the frame whose drawing starts now. The frame will be visible after it is drawn
+ * and after the display shows it. Predict the angle for that time, so what audience sees is in sync with the vector.
+ */
+void MainWindow::updateAngleForFrame(qint64 frameStartUs)
+{
+    predictionLeadUs = isRenderingOffscreen ? 0 : latencyMonitor.getRenderTimeUs() + qint64(displayLatencyMs) * 1000;
+
+    curAngleInDegrees = angleEstimator.predictAngle(frameStartUs, predictionLeadUs);
+
+    curAngleInRadians = curAngleInDegrees * M_PI / 180;
+    curHeight = int(amplitude * sin(curAngleInRadians));
+    curWidth  = int(amplitude * cos(curAngleInRadians));
+}
+
+void MainWindow::frameDrawn(qint64 frameStartUs, qint64 frameEndUs)
+{
+    latencyMonitor.addFrame(frameStartUs, frameEndUs, frameEndUs + qint64(displayLatencyMs) * 1000);
+
+    // exported frames are drawn at full quality, however long they take.
+    if (!renderWidget->isExporting())
+        qualityGovernor.addFrame(frameEndUs - frameStartUs, qint64(timerInterval) * 1000);
+}
+
+void MainWindow::showControlWindowCentered()
+{
+    cw->show();
+    cw->move(200, 50);
+}
+
+void MainWindow::on_actionControl_Panel_triggered()
+{
+    showControlWindowCentered();
+}
+
+void MainWindow::on_actionAbout_triggered()
+{
+    AboutDialog aboutDialog;
+    aboutDialog.setModal(true);
+    aboutDialog.exec();
+
+//    QMessageBox messageBox;
+//    messageBox.about(this, "About Rotating Vector", "Version 0.1.1\nAuthor: Abhir Joshi");
+}
@@ -0,0 +1,20 @@
+#ifndef PAINTDEVICE_H
+#define PAINTDEVICE_H
+
+#include <QPaintDevice>
+#include <QSizeF>
+
+/*
+ * Size of a paint device in logical pixels, the units painting is done in.  Widgets report their size in logical
+ * pixels, while images and pixmaps report it in device pixels, whatever their device pixel ratio.
+ */
+inline QSizeF getLogicalSize(const QPaintDevice *device)
+{
+    QSizeF size(device->width(), device->height());
+
+    if ((device->devType() == QInternal::Image) || (device->devType() == QInternal::Pixmap))
+        size /= device->devicePixelRatioF();
+    return size;
+}
+
+#endif // PAINTDEVICE_H
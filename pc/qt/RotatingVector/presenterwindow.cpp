@@ -0,0 +1,35 @@
+#include "presenterwindow.h"
+#include <QPainter>
+
+
+PresenterWindow::PresenterWindow(QWidget *parent) :
+    QWidget(parent, Qt::Window)
+{
+    setWindowTitle("Rotating Vector - Presenter");
+    resize(640, 360);
+}
+
+/*
+ * Frame must not be drawn into after this; the render widget draws the next frame into another image.
+ */
+void PresenterWindow::showFrame(const QImage &frame)
+{
+    this->frame = frame;
+    update();
+}
+
+void PresenterWindow::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+
+    p.fillRect(rect(), Qt::black);
+    if (frame.isNull())
+        return;
+
+    // whole frame, as large as fits without changing its aspect ratio, centered.
+    QSizeF frameSize = QSizeF(frame.size()) / frame.devicePixelRatioF();
+    QSizeF targetSize = frameSize.scaled(size(), Qt::KeepAspectRatio);
+    QRectF target(QPointF((width() - targetSize.width()) / 2, (height() - targetSize.height()) / 2), targetSize);
+
+    p.drawImage(target, frame);
+}
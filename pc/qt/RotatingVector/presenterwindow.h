@@ -0,0 +1,27 @@
+#ifndef PRESENTERWINDOW_H
+#define PRESENTERWINDOW_H
+
+#include <QWidget>
+#include <QImage>
+
+
+/*************************************************************************************************
+ Presenter's preview of what the audience sees, e.g. on the laptop panel while the render widget is
+ on the projector.  Nothing is drawn for it: it shows the very frame the render widget has drawn,
+ holding a reference to the frame's pixels (QImage is implicitly shared), scaled down to fit.
+ *************************************************************************************************/
+class PresenterWindow : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PresenterWindow(QWidget *parent = nullptr);
+    void showFrame(const QImage &frame);
+
+protected:
+    void paintEvent(QPaintEvent *pe);
+
+private:
+    QImage frame;
+};
+
+#endif // PRESENTERWINDOW_H
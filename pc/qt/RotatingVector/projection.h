@@ -1,78 +1,244 @@
-#ifndef PROJECTION_H
-#define PROJECTION_H
-
-#include <QPoint>
-#include <QPainter>
-
-
-/*************************************************************************************************
- This class manages projection at a given angle. It knows how to draw various parts of a projection
- such as: projection boxes, projection itself, axis, various important ordinate lines, angle values,
- observer, etc.  The functions that do the drawing should be called from the render widget.
- *************************************************************************************************/
-struct Projection
-{
-    double phase;
-    int *ordinates;
-    int maxOrdinates;
-    int *angles;
-
-    int axis_x;
-    int axis_y;
-
-    int unrotated_axis_x;
-    int unrotated_axis_y;
-
-    int amplitude;
-
-    int vector_origin_x;
-    int vector_origin_y;
-    int wallSeparation;
-
-    bool isPositionCalculated = false;
-
-    QImage *observerImage = nullptr;
-    QColor color;
-
-    const double waveOpacity = 0.7;
-    const double projectionOpacity = 0.7;
-
-public:
-    Projection(double phase_, int maxOrdinates_, QString observerFilename, QColor color_);
-    void clear();
-    void setPhase(double phase_);
-    void recalculatePosition();
-    QPoint getAxisPositionFromPhase(double phase_);
-    void recalculatePosition(int vector_origin_x, int vector_origin_y, int amplitude_, int wallSeparation);
-    int getCurrentHeight(int amplitude, double currentAngleInDegrees);
-    int getCurrentDepth(int amplitude, double currentAngleInDegrees);
-    void shiftAndSet(int amplitude, double currentAngleInDegrees, bool isVectorRunning, bool isClockwise);
-     void drawWave(QPainter *p, int abscissaScale, int penWidth);
-    void drawWave(QPainter *p, int abscissaScale, int penWidth, double phaseRotation);
-    void drawAngles(QPainter *p, int abscissaScale, bool showMultiplesOf30, bool showInRadians);
-    void drawVectorProjection(QPainter *p, double currentAngleInDegrees, int penWidth);
-    void drawVectorComponentInVectorSweepCircle(QPainter *p, double currentAngleInDegrees, int penWidth);
-    void drawVectorProjectionBoxes(QPainter *p, int penWidth);
-    void drawDottedLineFromVectorTip(QPainter *p, double currentAngleInDegrees, int vector_tip_x, int vector_tip_y);
-    void drawTipCircle(QPainter *p, double currentAngleInDegrees, int penWidth);
-    void drawTipCircleWithoutRotation(QPainter *p, double currentAngleInDegrees, int penWidth);
-    void drawLinesAtImportantCoordinates(QPainter *p, bool show1, bool show0p866, bool show0p707, bool show0p5,
-                                         bool show1Caption, bool show0p866Caption, bool show0p707Caption, bool show0p5Caption);
-    void drawLineThroughVectorSweepCircle(QPainter *p);
-    void drawPhaseArcFromGivenPhase(QPainter *p, double givenPhaseInDegrees, int penWidth);
-    void drawCircularText(QPainter *p, int x, int y, int radius, bool clockwise, double angleInDegrees, bool alignStart, QString& text);
-    void drawAxis(QPainter *p);
-
-    void drawObserver(QPainter *p);
-    QImage* locateAndInstantiateImage(QString filename);
-
-private:
-    void _drawRadianAngle(QPainter *p, int x, int y, int angleInRadian, int w1);
-    std::tuple<int, int> _getRadianAngleDisplayWidthAndHeight(int angleInDegree, int w1, int h1);
-    int _getRadianAngleDisplayWidth(int angleInDegree, int w1, int h1);
-    int _getRadianAngleDisplayHeight(int angleInDegree, int w1, int h1);
-
-};
-
-
-#endif // PROJECTION_H
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include <QPoint>
+#include <QPainter>
+#include <QTransform>
+#include <QFontMetrics>
+#include <QLine>
+#include <algorithm>
+#include <climits>
+#include <tuple>
+#include <vector>
+#include "labelatlas.h"
+#include "waverasterizer.h"
+
+
+/*************************************************************************************************
+ Angle of the vector at every frame, shared by all projections.  Newest sample is at age 0.  Kept
+ in a ring, so adding a sample doesn't move the older ones.  Only the angle is kept; projections
+ calculate their ordinates from it when drawing, with the amplitude and phase current at that time.
+ Ring is sized by the render widget to hold as many samples as the longest wave it can show.
+ *************************************************************************************************/
+struct SampleHistory
+{
+    int maxSamples;
+    int head = 0;                   // index of the newest sample
+    long long numSamples = 0;       // samples added so far. tells projections which samples were there before they were cleared.
+    int numStored = 0;              // samples in the ring, newest first. older ones were never taken or didn't fit.
+    float *anglesInDegrees;
+    int *angleLabels;               // angle (multiple of 30 or 45) marked on the sample, INT_MIN if none
+    int *ordinates;                 // ordinates of the projection being drawn. one buffer for all projections.
+    QPoint *vertices;               // wave of the projection being drawn, newest sample first
+
+public:
+    SampleHistory(int maxSamples_) :
+        maxSamples(maxSamples_)
+    {
+        anglesInDegrees = new float[maxSamples];
+        angleLabels = new int[maxSamples];
+        ordinates = new int[maxSamples];
+        vertices = new QPoint[maxSamples];
+        clear();
+    }
+    SampleHistory(const SampleHistory &) = delete;
+    ~SampleHistory()
+    {
+        delete[] anglesInDegrees;
+        delete[] angleLabels;
+        delete[] ordinates;
+        delete[] vertices;
+    }
+
+    void clear()
+    {
+        for (int i=0; i<maxSamples; i++)
+        {
+            anglesInDegrees[i] = 0;
+            angleLabels[i] = INT_MIN;
+        }
+        numStored = 0;
+    }
+
+    // keeps as many of the newest samples as fit
+    void resize(int newMaxSamples)
+    {
+        if (newMaxSamples == maxSamples)
+            return;
+
+        int numKept = std::min(numStored, newMaxSamples);
+        float *newAnglesInDegrees = new float[newMaxSamples];
+        int *newAngleLabels = new int[newMaxSamples];
+
+        for (int i=0; i<newMaxSamples; i++)
+        {
+            newAnglesInDegrees[i] = 0;
+            newAngleLabels[i] = INT_MIN;
+        }
+        for (int age=0; age<numKept; age++)
+        {
+            newAnglesInDegrees[numKept - 1 - age] = anglesInDegrees[indexOf(age)];
+            newAngleLabels[numKept - 1 - age] = angleLabels[indexOf(age)];
+        }
+
+        delete[] anglesInDegrees;
+        delete[] angleLabels;
+        delete[] ordinates;
+        delete[] vertices;
+
+        maxSamples = newMaxSamples;
+        anglesInDegrees = newAnglesInDegrees;
+        angleLabels = newAngleLabels;
+        ordinates = new int[maxSamples];
+        vertices = new QPoint[maxSamples];
+        head = (numKept > 0) ? numKept - 1 : maxSamples - 1;
+        numStored = numKept;
+    }
+
+    int indexOf(int age) const
+    {
+        return (head + maxSamples - age) % maxSamples;
+    }
+
+    // returns index of the added sample
+    int add(double angleInDegrees, int angleLabel)
+    {
+        head = (head + 1) % maxSamples;
+        anglesInDegrees[head] = float(angleInDegrees);
+        angleLabels[head] = angleLabel;
+        numSamples++;
+        numStored = std::min(numStored + 1, maxSamples);
+        return head;
+    }
+};
+
+
+/*************************************************************************************************
+ Orientation of a projection rotated by a multiple of 90 degrees.  Maps a point in projection
+ coordinates (abscissa along the axis, ordinate across it) to device coordinates relative to the
+ axis, same as QPainter::rotate() would, but with integer math and without touching the painter.
+ Projections at other phases rotate the painter instead.
+ *************************************************************************************************/
+template<int quarterTurns> struct AxisAlignedOrientation;
+
+template<> struct AxisAlignedOrientation<0> {   static QPoint map(int x, int y) {   return QPoint( x,  y);  }   };
+template<> struct AxisAlignedOrientation<1> {   static QPoint map(int x, int y) {   return QPoint(-y,  x);  }   };
+template<> struct AxisAlignedOrientation<2> {   static QPoint map(int x, int y) {   return QPoint(-x, -y);  }   };
+template<> struct AxisAlignedOrientation<3> {   static QPoint map(int x, int y) {   return QPoint( y, -x);  }   };
+
+// 0..3 if angle is a multiple of 90 degrees, -1 otherwise.
+int getQuarterTurns(double angleInDegrees);
+
+
+/*************************************************************************************************
+ This class manages projection at a given angle. It knows how to draw various parts of a projection
+ such as: projection boxes, projection itself, axis, various important ordinate lines, angle values,
+ observer, etc.  The functions that do the drawing should be called from the render widget.
+ *************************************************************************************************/
+struct Projection
+{
+    double phase;
+    int quarterTurns;               // of phase, -1 if projection isn't axis aligned
+    SampleHistory *history;
+    long long firstSample = 0;      // samples before this one were cleared
+
+    int axis_x;
+    int axis_y;
+
+    int unrotated_axis_x;
+    int unrotated_axis_y;
+
+    // kept up to date by setPhase() and recalculatePosition(), so drawing doesn't rebuild them.
+    double cosPhase;
+    double sinPhase;
+    QTransform transform;           // projection coordinates (origin at axis, rotated by phase) to widget coordinates
+
+    int amplitude;
+
+    int vector_origin_x;
+    int vector_origin_y;
+    int wallSeparation;
+
+    bool isPositionCalculated = false;
+
+    QImage *observerImage = nullptr;
+
+    // observer image rotated by phase, with opacity applied, as it is to be drawn. rendered again when phase or
+    // position changes.
+    QImage observerSprite;
+    QPoint observerSpritePosition;
+    bool isObserverSpriteValid = false;
+    qreal observerSpritePixelRatio = 0;
+    QColor color;
+
+    const double waveOpacity = 0.7;
+    const double projectionOpacity = 0.7;
+
+    // detail, reduced when frames take too long to draw
+    int waveDecimation = 1;             // every n'th sample of the wave is drawn
+    bool showGuideLines = true;         // faint lines: ordinate grid and perpendiculars under angle marks
+    bool useWaveRasterizer = false;     // axis aligned waves are drawn by waveRasterizers instead of the painter
+    WaveRasterizer waveRasterizers[4];  // by quarter turns of the wave. A wave drawn both along its own axis and
+                                        // along another keeps the image of each from frame to frame.
+
+    // angle marks collected by drawAngles(), to be drawn in one call each. kept to reuse their memory.
+    struct AngleLabel { int x; int y; int angle; };
+    std::vector<QLine> tickLines;
+    std::vector<QLine> perpendicularLines;
+    std::vector<QLine> zeroLines;
+    std::vector<AngleLabel> angleLabels;
+
+    // lead and lag captions along the phase arc, rendered when phase (or anything else they depend on) changes.
+    struct CircularTextGlyph { QPointF position; double rotation; QChar c; };
+    QImage phaseCaptionSprite;
+    QPoint phaseCaptionOffset;          // of the sprite from vector origin
+    bool isPhaseCaptionValid = false;
+    QColor phaseCaptionColor;
+    qreal phaseCaptionPixelRatio = 0;
+
+public:
+    Projection(double phase_, SampleHistory *history_, QString observerFilename, QColor color_);
+    Projection(const Projection &) = delete;
+    ~Projection();
+    void clear();
+    bool isCleared(int age);
+    bool getVisibleAges(QPainter *p, QPoint axis, double rotationInDegrees, int abscissaScale, int margin,
+                        int &firstAge, int &lastAge);
+    const int *calculateOrdinates(int firstAge, int lastAge);
+    void setPhase(double phase_);
+    void recalculatePosition();
+    QPoint getAxisPositionFromPhase(double phase_);
+    void recalculatePosition(int vector_origin_x, int vector_origin_y, int amplitude_, int wallSeparation);
+    int getCurrentHeight(int amplitude, double currentAngleInDegrees);
+    int getCurrentDepth(int amplitude, double currentAngleInDegrees);
+    void drawWave(QPainter *p, int abscissaScale, int penWidth);
+    void drawWave(QPainter *p, int abscissaScale, int penWidth, double phaseRotation);
+    void drawAngles(QPainter *p, const LabelAtlas &labels, int abscissaScale, bool showMultiplesOf30, bool showInRadians);
+    void drawVectorProjection(QPainter *p, double currentAngleInDegrees, int penWidth);
+    void drawVectorComponentInVectorSweepCircle(QPainter *p, double currentAngleInDegrees, int penWidth);
+    void drawVectorProjectionBoxes(QPainter *p, int penWidth);
+    void drawDottedLineFromVectorTip(QPainter *p, double currentAngleInDegrees, int vector_tip_x, int vector_tip_y);
+    void drawTipCircle(QPainter *p, double currentAngleInDegrees, int penWidth);
+    void drawTipCircleWithoutRotation(QPainter *p, double currentAngleInDegrees, int penWidth);
+    void drawLinesAtImportantCoordinates(QPainter *p, const LabelAtlas &labels,
+                                         bool show1, bool show0p866, bool show0p707, bool show0p5,
+                                         bool show1Caption, bool show0p866Caption, bool show0p707Caption, bool show0p5Caption);
+    void drawLineThroughVectorSweepCircle(QPainter *p);
+    void drawPhaseArcFromGivenPhase(QPainter *p, double givenPhaseInDegrees, int penWidth);
+    void drawAxis(QPainter *p);
+
+    void drawObserver(QPainter *p);
+    static QImage* loadImage(QString resourceName);
+
+private:
+    QPoint mapToDevice(int x, int y);
+    QLine mapToDevice(int x1, int y1, int x2, int y2);
+    void updatePhaseCaptionSprite(QPainter *p);
+    void updateObserverSprite(QPainter *p);
+    static void layoutCircularText(const QFontMetrics &fm, int radius, bool clockwise, double angleInDegrees, bool alignStart,
+                                   const QString &text, std::vector<CircularTextGlyph> &glyphs);
+
+};
+
+
+#endif // PROJECTION_H
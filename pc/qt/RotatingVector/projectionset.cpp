@@ -0,0 +1,116 @@
+#include "projectionset.h"
+#include <algorithm>
+#include <math.h>
+
+#define ANGLE_LABEL_SPACING     5       // an angle is marked only if none of these many previous samples is marked
+
+
+ProjectionSet::ProjectionSet(int maxSamples) :
+    history(maxSamples)
+{
+}
+
+ProjectionSet::~ProjectionSet()
+{
+    for (Projection *projection : projections)
+        delete projection;
+}
+
+/*
+ * New projection shows the history taken so far, as if it had been there from the start.
+ */
+Projection *ProjectionSet::add(double phase, QString observerFilename, QColor color)
+{
+    Projection *projection = new Projection(phase, &history, observerFilename, color);
+
+    if (isPositionCalculated)
+        projection->recalculatePosition(vector_origin_x, vector_origin_y, amplitude, wallSeparation);
+
+    projections.push_back(projection);
+    return projection;
+}
+
+void ProjectionSet::remove(Projection *projection)
+{
+    projections.erase(std::remove(projections.begin(), projections.end(), projection), projections.end());
+    delete projection;
+}
+
+int ProjectionSet::size() const                 {   return int(projections.size());     }
+Projection *ProjectionSet::at(int i) const      {   return projections[size_t(i)];      }
+
+void ProjectionSet::recalculatePosition(int vector_origin_x, int vector_origin_y, int amplitude, int wallSeparation)
+{
+    this->vector_origin_x = vector_origin_x;
+    this->vector_origin_y = vector_origin_y;
+    this->amplitude = amplitude;
+    this->wallSeparation = wallSeparation;
+    isPositionCalculated = true;
+
+    for (Projection *projection : projections)
+        projection->recalculatePosition(vector_origin_x, vector_origin_y, amplitude, wallSeparation);
+}
+
+/*
+ * Change size of the history, keeping as many of the newest samples as fit.
+ */
+void ProjectionSet::setMaxSamples(int maxSamples)
+{
+    history.resize(std::max(maxSamples, ANGLE_LABEL_SPACING));
+}
+
+void ProjectionSet::setDetail(int waveDecimation, bool showGuideLines)
+{
+    for (Projection *projection : projections)
+    {
+        projection->waveDecimation = waveDecimation;
+        projection->showGuideLines = showGuideLines;
+    }
+}
+
+void ProjectionSet::setWaveRasterizer(bool useWaveRasterizer)
+{
+    for (Projection *projection : projections)
+        projection->useWaveRasterizer = useWaveRasterizer;
+}
+
+/*
+ * Angle (multiple of 30 or 45) to be marked on the current sample, INT_MIN if none.
+ */
+int ProjectionSet::getAngleLabel(double currentAngleInDegrees, bool isVectorRunning, bool isClockwise)
+{
+    int intAngle = INT_MIN;
+    if (isVectorRunning)
+    {
+        intAngle= int(round(currentAngleInDegrees));
+        if (isClockwise)
+            intAngle = (intAngle - 360) % 360;
+
+        // don't set angle is not a multiple of 30 or 45.
+        if (((intAngle % 30) != 0) && ((intAngle % 45) != 0))
+            intAngle = INT_MIN;
+
+        if (intAngle == 360)
+            intAngle = 0;
+    }
+
+    // If a current angle is specified, set it only if the previous few samples didn't have any angle set.
+    if (intAngle != INT_MIN)
+    {
+        for (int age=0; age<ANGLE_LABEL_SPACING; age++)
+        {
+            if (history.angleLabels[history.indexOf(age)] != INT_MIN)
+                return INT_MIN;
+        }
+    }
+    return intAngle;
+}
+
+/*
+ * Add current angle to the history. Projections calculate their ordinates from it when drawing.
+ */
+void ProjectionSet::addSample(double currentAngleInDegrees, bool isVectorRunning, bool isClockwise)
+{
+    int angleLabel = getAngleLabel(currentAngleInDegrees, isVectorRunning, isClockwise);
+    history.add(currentAngleInDegrees, angleLabel);
+}
@@ -0,0 +1,45 @@
+#ifndef PROJECTIONSET_H
+#define PROJECTIONSET_H
+
+#include <vector>
+#include "projection.h"
+
+
+/*************************************************************************************************
+ Any number of projections (observers) of the same rotating vector, each at its own phase.  All
+ of them share one sample history, as every projection derives its ordinates from the same angle.
+ Memory used doesn't depend on the number of projections.
+ *************************************************************************************************/
+class ProjectionSet
+{
+public:
+    ProjectionSet(int maxSamples);
+    ProjectionSet(const ProjectionSet &) = delete;
+    ~ProjectionSet();
+
+    Projection *add(double phase, QString observerFilename, QColor color);
+    void remove(Projection *projection);
+    int size() const;
+    Projection *at(int i) const;
+
+    void recalculatePosition(int vector_origin_x, int vector_origin_y, int amplitude, int wallSeparation);
+    void addSample(double currentAngleInDegrees, bool isVectorRunning, bool isClockwise);
+    void setMaxSamples(int maxSamples);
+    void setDetail(int waveDecimation, bool showGuideLines);
+    void setWaveRasterizer(bool useWaveRasterizer);
+
+    SampleHistory history;
+
+private:
+    int getAngleLabel(double currentAngleInDegrees, bool isVectorRunning, bool isClockwise);
+
+    std::vector<Projection*> projections;
+
+    bool isPositionCalculated = false;
+    int vector_origin_x = 0;
+    int vector_origin_y = 0;
+    int amplitude = 0;
+    int wallSeparation = 0;
+};
+
+#endif // PROJECTIONSET_H
@@ -0,0 +1,53 @@
+#include "qualitygovernor.h"
+
+void QualityGovernor::reset()
+{
+    level = FULL_QUALITY;
+    frameTimeUs = 0;
+    numFramesOverLoad = 0;
+    numFramesUnderLoad = 0;
+}
+
+/*
+ * A frame took 'frameTimeUs' to draw. Returns true if quality level has changed.
+ */
+bool QualityGovernor::addFrame(qint64 frameTimeUs, qint64 frameBudgetUs)
+{
+    this->frameTimeUs += QUALITY_SMOOTHING * (frameTimeUs - this->frameTimeUs);
+
+    double load = this->frameTimeUs / qMax<qint64>(frameBudgetUs, 1);
+
+    numFramesOverLoad  = (load > QUALITY_DOWN_LOAD) ? numFramesOverLoad + 1 : 0;
+    numFramesUnderLoad = (load < QUALITY_UP_LOAD)   ? numFramesUnderLoad + 1 : 0;
+
+    int newLevel = level;
+    if ((numFramesOverLoad >= QUALITY_DOWN_FRAMES) && (level < NUM_QUALITY_LEVELS - 1))
+        newLevel = level + 1;
+    else if ((numFramesUnderLoad >= QUALITY_UP_FRAMES) && (level > FULL_QUALITY))
+        newLevel = level - 1;
+
+    if (newLevel == level)
+        return false;
+
+    // give the new level time to show its effect on frame time before judging it.
+    level = newLevel;
+    numFramesOverLoad = 0;
+    numFramesUnderLoad = 0;
+    return true;
+}
+
+QualityGovernor::Level QualityGovernor::getLevel() const
+{
+    return Level(level);
+}
+
+const char *QualityGovernor::getLevelDescription() const
+{
+    switch (level)
+    {
+    case DECIMATED_WAVE:            return "Reduced quality: waves decimated";
+    case NO_GUIDE_LINES:            return "Reduced quality: waves decimated, no guide lines";
+    case NO_SCROLLING_BACKGROUND:   return "Reduced quality: waves decimated, no guide lines, no background";
+    }
+    return "Full quality";
+}
@@ -0,0 +1,49 @@
+#ifndef QUALITYGOVERNOR_H
+#define QUALITYGOVERNOR_H
+
+#include <QtGlobal>
+
+#define QUALITY_SMOOTHING               0.1         // how fast smoothed frame time follows the measured one
+#define QUALITY_DOWN_LOAD               0.8         // frame time / frame budget above which quality is reduced
+#define QUALITY_UP_LOAD                 0.4         // frame time / frame budget below which quality is restored
+#define QUALITY_DOWN_FRAMES             10          // frames to be over load before reducing quality
+#define QUALITY_UP_FRAMES               150         // frames to be under load before restoring quality
+
+/*************************************************************************************************
+ Watches the time taken to draw frames and reduces rendering quality when it gets close to the
+ frame budget (the render timer interval), so that the waves keep moving smoothly on slow PCs.
+
+ Quality goes down one level at a time, in this order, and each level includes the ones before it:
+
+    - every other sample of the waves is drawn.
+    - faint guide lines (ordinate grid, perpendiculars under angle marks) are not drawn.
+    - scrolling background is not drawn.
+
+ Quality is restored one level at a time once frames take well under the budget for a while.  The
+ gap between the two loads, and the longer wait to restore, keep it from toggling back and forth.
+ *************************************************************************************************/
+class QualityGovernor
+{
+public:
+    enum Level
+    {
+        FULL_QUALITY,
+        DECIMATED_WAVE,
+        NO_GUIDE_LINES,
+        NO_SCROLLING_BACKGROUND,
+        NUM_QUALITY_LEVELS
+    };
+
+    void reset();
+    bool addFrame(qint64 frameTimeUs, qint64 frameBudgetUs);
+    Level getLevel() const;
+    const char *getLevelDescription() const;
+
+private:
+    int level = FULL_QUALITY;
+    double frameTimeUs = 0;
+    int numFramesOverLoad = 0;
+    int numFramesUnderLoad = 0;
+};
+
+#endif // QUALITYGOVERNOR_H
@@ -1,618 +1,935 @@
-#include "renderwidget.h"
-#include <QPen>
-#include <QPainter>
-#include <QRandomGenerator>
-#include "mainwindow.h"
-#include <QDir>
-#include <QImage>
-
-RenderWidget::RenderWidget(QWidget *parent, MainWindow *data) :
-    QWidget(parent)
-{
-    this->data = data;
-
-    yProjection.setPhase(data->phaseShiftFromSine);
-
-    connect(timer, SIGNAL(timeout()), this, SLOT(renderTimerEvent()));
-
-    timer->start(data->timerInterval);
-
-    //----------------------------------------------------------------
-    QRandomGenerator randomGen(10);
-    hzScrollingBackground.generateRandomAnglePoints(      -200, 1700, 0, 800, randomGen);
-    hzScrollingBackground.generateRandomBackgroundPoints( -200, 1900, 0, 800, randomGen);
-    hzScrollingBackground.generateRandomTimePoints(       -200, 1700, 0, 800, randomGen);
-
-    vtScrollingBackground.generateRandomAnglePoints(      0, 500, 0, 800, randomGen);
-    vtScrollingBackground.generateRandomBackgroundPoints( 0, 500, 0, 800, randomGen);
-    vtScrollingBackground.generateRandomTimePoints(       0, 500, 0, 800, randomGen);
-}
-
-void RenderWidget::resizeEvent(QResizeEvent* event)
-{
-    QWidget::resizeEvent(event);
-
-    recalculateVectorOrigin();
-}
-
-/*
- * E.g. of when recalculation of vector position is required: when its offset from the bottom or right changes, or its amplitude changes.
- */
-void RenderWidget::recalculateVectorOrigin()
-{
-    vectorOrigin.setX(width() - data->amplitude - 135 - data->extraVectorOffsetFromRight);
-    vectorOrigin.setY(height() - data->amplitude - 135 - data->extraVectorOffsetFromBottom);
-
-    notifyPositionChange();
-}
-
-void RenderWidget::notifyPositionChange()
-{
-    xProjection.recalculatePosition(vectorOrigin.x(), vectorOrigin.y(), data->amplitude, wallSeparation);
-    yProjection.recalculatePosition(vectorOrigin.x(), vectorOrigin.y(), data->amplitude, wallSeparation);
-}
-
-void RenderWidget::updatePhaseShiftFromSine()
-{
-    yProjection.setPhase(data->phaseShiftFromSine);
-}
-
-void RenderWidget::lowPassFilterAngleDifference(double newAngleInDegrees)
-{
-    double difference = fabs(newAngleInDegrees - previousAngleInDegrees);
-
-    // This method is called everytime GUI update is performed, which could be several times between
-    // consecutive angle updates. Hence alpha has to be small.
-    // E.g. if alpha = 0.5, smoothed angle could get close to 0 if vector speed is slow (vector updates come every 100s or ms),
-    //      and GUI update is fast (less delay between GUI timer firing... 10s of ms).
-    // This will cause angle to be not displayed at 0, 90, 180 & 270 due to low smoothed angle threshold.
-    double alpha = 0.1;
-    if (difference > 2)
-    {
-        // Ignore this difference. Must be due to 0 -> 360 rollover.
-    }
-    else
-    {
-        smoothedChangeInAngle = (smoothedChangeInAngle * (1-alpha)) + (difference * alpha);
-    }
-    //printf("Calculated smoothed angle diff.  difference = %lf\n", difference);
-}
-
-void RenderWidget::clearSinOrdinates()
-{
-    xProjection.clear();
-}
-
-void RenderWidget::clearCosOrdinates()
-{
-    yProjection.clear();
-}
-
-void RenderWidget::updateTimerInterval()
-{
-    timer->start(data->timerInterval);
-}
-
-
-void RenderWidget::renderTimerEvent()
-{
-//    printf("Timer event\n");
-    repaint();
-}
-
-void RenderWidget::paintEvent(QPaintEvent *pe)
-{
-    QWidget::paintEvent(pe);
-
-    data->renderWidgetPaintEvent();
-
-    QPainter p(this);
-
-    draw(&p);
-
-}
-
-
-void RenderWidget::draw(QPainter * p)
-{
-    //----------------------------------------------------------------------------------------------------------
-    // Decide if vector (arduino or simulator) is rotating. Use low pass filter on angle difference.
-    // if it is rotating, and if current angle is 0, 90, 180 and 270, it will be applied on current ordinate.
-    //----------------------------------------------------------------------------------------------------------
-    // if time is not paused, we are feeding current angle to sine/cosine plot. LPF to get smoothed angle diff.
-    // if time paused, sine/cosine is frozen. smoothed angle diff can stay where it is.
-    if (!data->isTimePaused)
-    {
-        lowPassFilterAngleDifference(data->curAngleInDegrees);
-    }
-    previousAngleInDegrees = data->curAngleInDegrees;
-    isVectorOrArduinoRunning = smoothedChangeInAngle > 0.2;
-    //----------------------------------------------------------------------------------------------------------
-
-    QFont font;
-
-    VectorDrawingCoordinates v;
-
-    // Automatically set vector origin coords baseds on window width and height.  Then add offsets to it.
-    v.vector_origin_x = vectorOrigin.x();
-    v.vector_origin_y = vectorOrigin.y();
-
-    v.vector_width  = int(data->amplitude * cos(data->curAngleInRadians));
-    v.vector_height = int(data->amplitude * sin(data->curAngleInRadians));
-
-    v.vector_tip_x = v.vector_origin_x + v.vector_width;
-    v.vector_tip_y = v.vector_origin_y - v.vector_height;
-
-    v.xaxis_x = v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth/2;
-    v.xaxis_y = v.vector_origin_y;
-
-    v.yaxis_x = v.vector_origin_x;
-    v.yaxis_y = v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth/2;
-
-    v.vproj_origin_x = v.vector_origin_x - data->amplitude - wallSeparation;
-    v.vproj_origin_y = v.vector_origin_y;
-
-    v.hproj_origin_x = v.vector_origin_x;
-    v.hproj_origin_y = v.vector_origin_y - data->amplitude - wallSeparation;
-
-
-    drawAxis(p);
-    drawProjectionBoxes(p);
-
-    drawBackground(p, v);
-    drawSineAndCosinePoints(p);
-    drawLinesAtImportantOrdinateValues(p);
-
-    drawRotatingVectorComponents(p, v);
-    drawRotatingVector(p, v);
-    drawVectorProjection(p, v);
-
-    // For the projection tip circle to show correctly, draw this after drawing sin & cos points and vector projection dotted line.
-    drawTipCircles(p, v);
-
-    drawObservers(p);
-}
-
-
-void RenderWidget::drawProjectionBoxes(QPainter *p)
-{
-    //-------------------------------------------------------------------
-    // Draw rectangle that will have the vector's vertical shadow
-    //-------------------------------------------------------------------
-    QFont font = QFont();
-    font.setPixelSize(13);
-//    font.setStretch(2.0);
-    p->setFont(font);
-    QFontMetrics fm(font);
-    QString str;
-    QPen pen;
-
-    if (data->showVerticalProjectionBox)
-    {
-        pen = QPen(QColor(100, 100, 100));
-        pen.setWidth(2);
-        pen.setCapStyle(Qt::RoundCap);
-        p->setPen(pen);
-        p->setOpacity(0.2);
-
-        xProjection.drawVectorProjectionBoxes(p, data->penWidth);
-
-        p->setOpacity(1);
-
-        //---------------------------------------------------------
-//        font.setPixelSize(20);
-//        p->setFont(font);
-//        p->drawText(v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth - 25,
-//                    v.vector_origin_y - data->amplitude - 5,
-//                    "+1");
-//        p->drawText(v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth - 18,
-//                    v.vector_origin_y + data->amplitude + 20,
-//                    "-1");
-
-    }
-
-    //-------------------------------------------------------------------
-    // Draw rectangle that will have the vector's horizontal projection (not shadow. no vector casting horizontal shadow)
-    //-------------------------------------------------------------------
-    pen.setColor(QColor(150,150,150));
-    p->setPen(pen);
-
-    if (data->showHorizontalProjectionBox)
-    {
-        pen = QPen(QColor(100, 100, 100));
-        pen.setWidth(2);
-        pen.setCapStyle(Qt::RoundCap);
-        p->setPen(pen);
-        p->setOpacity(0.2);
-
-        yProjection.drawVectorProjectionBoxes(p, data->penWidth);
-
-        p->setOpacity(1);
-
-        //---------------------------------------------------------
-//        p->drawText(v.vector_origin_x - data->amplitude - 23,
-//                    v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth,
-//                    "-1");
-//        p->drawText(v.vector_origin_x + data->amplitude + 3,
-//                    v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth,
-//                    "+1");
-    }
-
-}
-
-void RenderWidget::drawBackground(QPainter *p, VectorDrawingCoordinates v)
-{
-    if (data->showScrollingBackgroundText)
-    {
-        //--------------------------------------------------------------------
-        // Draw Horizontal background
-        //--------------------------------------------------------------------
-        QFont font = QFont();
-        font.setPixelSize(30);
-        QPen pen = QPen(scrollingBackgroundColor);
-        p->setPen(pen);
-        p->setBrush(Qt::green);
-        p->setFont(font);
-
-        if (data->showSinOnXAxis)
-        {
-            p->setOpacity(0.2);
-
-            hzScrollingBackground.draw(*p,
-                                       0,                                               // x offset
-                                       v.vector_origin_y - data->amplitude,             // y offset
-                                       v.vector_origin_x - data->amplitude,             // width of rectangle to draw in
-                                       data->amplitude * 2                              // height of rectangle to draw in
-            );
-
-            if (!data->isTimePaused)
-                hzScrollingBackground.shiftLeft(data->timeXInc);
-
-            pen = QPen(cosColor);
-            p->setPen(pen);
-            p->setBrush(sinColor);
-            p->setOpacity(0.05);
-            p->drawRect(0,
-                        v.vector_origin_y - data->amplitude - wallSeparation,
-                        v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth/2,
-                        2 * (data->amplitude + wallSeparation));
-
-            p->setOpacity(1);
-        }
-
-        if (data->showCosOnYAxis)
-        {
-            //--------------------------------------------------------------------
-            // Draw Vertical background
-            //--------------------------------------------------------------------
-            pen = QPen(scrollingBackgroundColor);
-            p->setPen(pen);
-            p->setOpacity(0.2);
-
-            vtScrollingBackground.draw(*p,
-                                       v.vector_origin_x - data->amplitude,               // x offset
-                                       0,                                                 // y offset
-                                       data->amplitude * 2,                               // width of rectangle to draw in
-                                       v.vector_origin_y - data->amplitude                // height of rectangle to draw in
-            );
-
-            if (!data->isTimePaused)
-                vtScrollingBackground.shiftUp(data->timeXInc);
-
-            pen = QPen(cosColor);
-            p->setPen(pen);
-            p->setBrush(cosColor);
-            p->setOpacity(0.05);
-            p->drawRect(v.vector_origin_x - data->amplitude - wallSeparation,
-                        0,
-                        2 * (data->amplitude + wallSeparation),
-                        v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth/2);
-            p->setOpacity(1);
-        }
-    }
-}
-
-void RenderWidget::drawRotatingVectorComponents(QPainter *p, VectorDrawingCoordinates v)
-{
-    if (data->drawSinComponent)
-    {
-        // Drop a line from vector tip perpendicular to X axis
-        xProjection.drawVectorComponentInVectorSweepCircle(p, data->curAngleInDegrees, data->penWidth);
-    }
-
-    if (data->drawCosComponent)
-    {
-        // Draw a line from vector tip perpendicular to the axis of current phase
-        yProjection.drawVectorComponentInVectorSweepCircle(p, data->curAngleInDegrees, data->penWidth);
-    }
-    p->setOpacity(1);
-}
-
-
-void RenderWidget::drawRotatingVector(QPainter *p, VectorDrawingCoordinates v)
-{
-    //--------------------------------------------------------------------
-    // Draw rotating vector, if enabled
-    //--------------------------------------------------------------------
-    if (data->drawRotatingVector)
-    {
-        //----------------------------------------------------
-        // Draw vector x & y axis and tracing circle
-        QPen pen = QPen(QColor(120, 120, 120));
-        pen.setWidth(2);
-        pen.setCapStyle(Qt::RoundCap);
-        p->setPen(pen);
-        p->setBrush(vectorSweepColor);
-        p->setOpacity(0.1);
-        p->drawEllipse(v.vector_origin_x - data->amplitude,
-                       v.vector_origin_y - data->amplitude,
-                       2 * data->amplitude,
-                       2 * data->amplitude
-        );
-
-        p->setOpacity(0.3);
-        xProjection.drawLineThroughVectorSweepCircle(p);
-        yProjection.drawLineThroughVectorSweepCircle(p);
-
-        if (data->phaseShiftArcAndCaption)
-            yProjection.drawPhaseArcFromGivenPhase(p, xProjection.phase, data->penWidth);
-
-        //----------------------------------------------------
-        // Draw vector itself.
-        pen = QPen(vectorColor);
-        pen.setWidth(data->penWidth);
-        pen.setCapStyle(Qt::RoundCap);
-        p->setPen(pen);
-        p->setBrush(vectorColor);
-        p->setOpacity(1);
-        p->drawLine(v.vector_origin_x,
-                    v.vector_origin_y,
-                    v.vector_tip_x,
-                    v.vector_tip_y
-        );
-
-        //----------------------------------------------------
-        // Draw arc showing the region from 0 degrees that forms the current angle.
-        if (data->drawAngleArc)
-        {
-            pen = QPen(Qt::black);
-            pen.setWidth(2);
-            pen.setCapStyle(Qt::RoundCap);
-            p->setPen(pen);
-            p->setBrush(vectorColor);
-            p->setOpacity(0.3);
-
-            int arcRadius = data->amplitude / 10;
-            p->drawArc(v.vector_origin_x - arcRadius,
-                       v.vector_origin_y - arcRadius,
-                       2 * arcRadius,
-                       2 * arcRadius,
-                       0 * 16,
-                       int(data->curAngleInDegrees * 16)
-            );
-
-            QFont font = QFont();
-            font.setPixelSize(40);
-            p->setFont(font);
-            p->setOpacity(0.7);
-
-            QFontMetrics fm(font);
-            QString angleString = QString::number(int(round(data->curAngleInDegrees))) + "°";
-            int w = fm.horizontalAdvance(angleString);
-
-            p->drawText(v.vector_origin_x - w/2,
-                        v.vector_origin_y + data->amplitude + 60,
-                        angleString);
-        }
-    }
-
-}
-
-void RenderWidget::drawVectorProjection(QPainter *p, VectorDrawingCoordinates v)
-{
-    QPen pen = QPen();
-    pen.setWidth(1);
-    pen.setCapStyle(Qt::RoundCap);
-    p->setOpacity(0.7);
-
-    //--------------------------------------------------------------------
-    // VerticalpProjection
-    //--------------------------------------------------------------------
-    if (data->drawVerticalShadow)
-    {
-        pen.setColor(sinColor);
-        p->setPen(pen);
-        p->setBrush(sinColor);
-        xProjection.drawVectorProjection(p, data->curAngleInDegrees, data->penWidth);
-    }
-
-    //--------------------------------------------------------------------
-    // Horizontal projection
-    //--------------------------------------------------------------------
-    if (data->drawHorizontalShadow)
-    {
-        pen.setColor(cosColor);
-        p->setPen(pen);
-        p->setBrush(cosColor);
-        yProjection.drawVectorProjection(p, data->curAngleInDegrees, data->penWidth);
-    }
-    p->setOpacity(1);
-
-    //--------------------------------------------------------------------
-    // Dotted line showing projection
-    //--------------------------------------------------------------------
-    pen = QPen(QColor(20, 20, 20));
-    pen.setWidth(5);
-    pen.setStyle(Qt::DotLine);
-    p->setPen(pen);
-    p->setOpacity(0.1);
-
-    if (data->drawVerticalProjectionDottedLine)
-    {
-        // For vertical projection: from wall to vector tip.
-        xProjection.drawDottedLineFromVectorTip(p, data->curAngleInDegrees, v.vector_tip_x, v.vector_tip_y);
-    }
-
-    if (data->drawHorizontalProjectionDottedLine)
-    {
-        // For horizontal projection: from ceiling to vector tip.
-        yProjection.drawDottedLineFromVectorTip(p, data->curAngleInDegrees, v.vector_tip_x, v.vector_tip_y);
-    }
-    p->setOpacity(1);
-}
-
-void RenderWidget::drawSineAndCosinePoints(QPainter *p)
-{
-//    printf("smoothedChangeInAngle = %lf\n", smoothedChangeInAngle);
-    if (!data->isTimePaused)
-    {
-        // Feed all projection axis
-        xProjection.shiftAndSet(data->amplitude,
-                                data->curAngleInDegrees,
-                                isVectorOrArduinoRunning,
-                                !data->arduinoSimulator->isCounterClockwise);
-
-        yProjection.shiftAndSet(data->amplitude,
-                                data->curAngleInDegrees,
-                                isVectorOrArduinoRunning,
-                                !data->arduinoSimulator->isCounterClockwise);
-    }
-
-    //--------------------------------------------------------------------
-    // Draw sine points
-    //--------------------------------------------------------------------
-    if (data->showSinOnXAxis)
-    {
-        xProjection.drawWave(p, data->timeXInc, data->penWidth);
-    }
-
-    //--------------------------------------------------------------------
-    // Draw cosine points
-    //--------------------------------------------------------------------
-    if (data->showCosOnYAxis)
-    {
-        yProjection.drawWave(p, data->timeXInc, data->penWidth);
-        if (data->showAnglesOnXAndYAxis)
-            yProjection.drawAngles(p, data->timeXInc, data->show30And60Angles, data->showAngleInRadians);
-    }
-
-    //--------------------------------------------------------------------
-    // Draw cosine on X axis along with sine so as to compare the 90 degree phase shift.
-    if (data->showCosOnXAxis)
-    {
-        yProjection.drawWave(p, data->timeXInc, data->penWidth, 0);
-    }
-
-    // Draw angles after potentially drawing Cosine on X axis. This will ensure the marks and angles are on top of sine & cosine lines.
-    if (data->showSinOnXAxis)
-    {
-        if (data->showAnglesOnXAndYAxis)
-            xProjection.drawAngles(p, data->timeXInc, data->show30And60Angles, data->showAngleInRadians);
-    }
-    p->setOpacity(1);
-}
-
-
-void RenderWidget::drawLinesAtImportantOrdinateValues (QPainter *p)
-{
-    QPen pen = QPen(QColor(50, 50, 50));
-    pen.setWidth(2);
-    p->setPen(pen);
-
-    QFont font;
-    font.setPixelSize(15);
-    p->setFont(font);
-
-
-    if (data->showSinOnXAxis)
-    {
-        if (data->showAllOrdinates)
-            xProjection.drawLinesAtImportantCoordinates(p, true, true, true, true,
-                                                        data->showOrdinateCaptions,
-                                                        data->showOrdinateCaptions,
-                                                        data->showOrdinateCaptions,
-                                                        data->showOrdinateCaptions);
-        else
-        {
-            if (data->show1AndMinus1Ordinates)
-                xProjection.drawLinesAtImportantCoordinates(p, true, false, false, false,
-                                                            data->showOrdinateCaptions,
-                                                            data->showOrdinateCaptions,
-                                                            data->showOrdinateCaptions,
-                                                            data->showOrdinateCaptions);
-        }
-    }
-
-    if (data->showCosOnYAxis)
-    {
-        if (data->showAllOrdinates)
-            yProjection.drawLinesAtImportantCoordinates(p, true, true, true, true,
-                                                        data->showOrdinateCaptions,
-                                                        data->showOrdinateCaptions,
-                                                        data->showOrdinateCaptions,
-                                                        data->showOrdinateCaptions);
-        else
-        {
-            if (data->show1AndMinus1Ordinates)
-                yProjection.drawLinesAtImportantCoordinates(p, true, false, false, false,
-                                                            data->showOrdinateCaptions,
-                                                            data->showOrdinateCaptions,
-                                                            data->showOrdinateCaptions,
-                                                            data->showOrdinateCaptions);
-        }
-    }
-}
-
-
-void RenderWidget::drawTipCircles(QPainter *p, VectorDrawingCoordinates v)
-{
-    QPen pen = QPen(vectorTipCircleColor);
-    pen.setWidth(2);
-    pen.setCapStyle(Qt::RoundCap);
-    p->setPen(pen);
-    p->setBrush(Qt::white);
-    p->setOpacity(1);
-
-    if (data->drawRotatingVector)
-    {
-        // Draw a circle at the tip of the vector
-        p->drawEllipse(v.vector_tip_x - data->penWidth / 2,
-                       v.vector_tip_y - data->penWidth / 2,
-                       data->penWidth,
-                       data->penWidth);
-    }
-    if (data->drawVerticalProjectionTipCircle)
-        xProjection.drawTipCircle(p, data->curAngleInDegrees, data->penWidth);      // Draw a circle at the tip of the vector's vertical projection
-
-    if (data->drawHorizontalProjectionTipCircle && data->drawHorizontalShadow)
-        yProjection.drawTipCircle(p, data->curAngleInDegrees, data->penWidth);      // Draw a circle at the tip of the vector's horizontal projection
-
-    if (data->showCosOnXAxis && data->drawHorizontalProjectionTipCircle)
-        yProjection.drawTipCircleWithoutRotation(p, data->curAngleInDegrees, data->penWidth);
-
-    p->setOpacity(1);
-}
-
-void RenderWidget::drawAxis(QPainter *p)
-{
-    //-------------------------------------------------------------------
-    // Draw X & Y axis
-    //--------------------------------------------------------------------
-    QPen pen = QPen(QColor(80, 80, 80));
-    pen.setWidth(2);
-    pen.setCapStyle(Qt::RoundCap);
-    p->setPen(pen);
-    p->setOpacity(0.7);
-
-    if (data->showSinOnXAxis)
-        xProjection.drawAxis(p);
-
-    if (data->showCosOnYAxis)
-        yProjection.drawAxis(p);
-}
-
-void RenderWidget::drawObservers(QPainter *p)
-{
-    xProjection.drawObserver(p);
-    yProjection.drawObserver(p);
-}
+#include "renderwidget.h"
+#include <QPen>
+#include <QPainter>
+#include <QRandomGenerator>
+#include "mainwindow.h"
+#include <QDir>
+#include <QImage>
+#include <QCoreApplication>
+
+RenderWidget::RenderWidget(QWidget *parent, MainWindow *data) :
+    QWidget(parent)
+{
+    this->data = data;
+
+    yProjection->setPhase(data->phaseShiftFromSine);
+    updateThreePhase();
+
+    connect(timer, SIGNAL(timeout()), this, SLOT(renderTimerEvent()));
+    connect(exportTimer, SIGNAL(timeout()), this, SLOT(exportTimerEvent()));
+
+    timer->start(data->timerInterval);
+
+    //----------------------------------------------------------------
+    QRandomGenerator randomGen(10);
+    hzScrollingBackground.generateRandomAnglePoints(      -200, 1700, 0, 800, randomGen);
+    hzScrollingBackground.generateRandomBackgroundPoints( -200, 1900, 0, 800, randomGen);
+    hzScrollingBackground.generateRandomTimePoints(       -200, 1700, 0, 800, randomGen);
+
+    vtScrollingBackground.generateRandomAnglePoints(      0, 500, 0, 800, randomGen);
+    vtScrollingBackground.generateRandomBackgroundPoints( 0, 500, 0, 800, randomGen);
+    vtScrollingBackground.generateRandomTimePoints(       0, 500, 0, 800, randomGen);
+}
+
+void RenderWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+
+    recalculateVectorOrigin();
+    projections.setMaxSamples(getNumSamplesToFill());
+
+    if (!pendingExportPath.isEmpty())
+        QTimer::singleShot(0, this, &RenderWidget::startPendingExport);
+}
+
+void RenderWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    if (!pendingExportPath.isEmpty())
+        QTimer::singleShot(0, this, &RenderWidget::startPendingExport);
+}
+
+/*
+ * Number of samples in the longest wave the widget can show: one that runs across its diagonal, one sample per
+ * pixel (the smallest time increment).
+ */
+int RenderWidget::getNumSamplesToFill()
+{
+    return int(ceil(hypot(width(), height()))) + 2;
+}
+
+/*
+ * E.g. of when recalculation of vector position is required: when its offset from the bottom or right changes, or its amplitude changes.
+ */
+void RenderWidget::recalculateVectorOrigin()
+{
+    vectorOrigin.setX(width() - data->amplitude - 135 - data->extraVectorOffsetFromRight);
+    vectorOrigin.setY(height() - data->amplitude - 135 - data->extraVectorOffsetFromBottom);
+
+    notifyPositionChange();
+}
+
+void RenderWidget::notifyPositionChange()
+{
+    projections.recalculatePosition(vectorOrigin.x(), vectorOrigin.y(), data->amplitude, wallSeparation);
+}
+
+void RenderWidget::updatePhaseShiftFromSine()
+{
+    yProjection->setPhase(data->phaseShiftFromSine);
+}
+
+/*
+ * Three phase demo: two more projections, 120 and 240 degrees from sine.
+ */
+void RenderWidget::updateThreePhase()
+{
+    if (data->showThreePhase && threePhaseProjections.empty())
+    {
+        threePhaseProjections.push_back(projections.add(120, "", threePhaseColors[0]));
+        threePhaseProjections.push_back(projections.add(240, "", threePhaseColors[1]));
+    }
+    else if (!data->showThreePhase)
+    {
+        for (Projection *projection : threePhaseProjections)
+            projections.remove(projection);
+        threePhaseProjections.clear();
+    }
+}
+
+/*
+ * Three phase projections are drawn on the X axis along with sine, hence are cleared with it.
+ */
+void RenderWidget::clearSinOrdinates()
+{
+    xProjection->clear();
+
+    for (Projection *projection : threePhaseProjections)
+        projection->clear();
+}
+
+void RenderWidget::clearCosOrdinates()
+{
+    yProjection->clear();
+}
+
+void RenderWidget::updateTimerInterval()
+{
+    timer->start(data->timerInterval);
+}
+
+
+void RenderWidget::renderTimerEvent()
+{
+//    printf("Timer event\n");
+    repaint();
+}
+
+void RenderWidget::paintEvent(QPaintEvent *pe)
+{
+    QWidget::paintEvent(pe);
+
+    // frames are drawn by the export timer, not for the screen.
+    if (exporter.isRunning() && isExportOffscreen)
+    {
+        QPainter p(this);
+        drawExportStatus(&p);
+        return;
+    }
+
+    qint64 frameStartUs = pcClockUs();
+    {
+        QPainter p(this);
+
+        //----------------------------------------------------------------
+        // When exporting, mirroring to the presenter window or rendering at a reduced scale, frame is drawn into an
+        // image once and shown from there. If the exporter has no free frame, the frame is missing from the export.
+        //----------------------------------------------------------------
+        QImage *exportFrame = exporter.acquireFrame();
+        QImage *frame = (exportFrame != nullptr) ? exportFrame : getInternalFrame();
+
+        if (frame != nullptr)
+        {
+            drawFrame(frame, frameStartUs);
+
+            if (frame->devicePixelRatioF() == devicePixelRatioF())
+            {
+                p.drawImage(0, 0, *frame);
+            }
+            else
+            {
+                p.setRenderHint(QPainter::SmoothPixmapTransform);
+                p.drawImage(QRectF(rect()), *frame);
+            }
+            showInPresenterWindow(*frame);
+
+            if (exportFrame != nullptr)
+            {
+                exporter.submitFrame(exportFrame);
+                numExportFrames++;
+            }
+        }
+        else
+        {
+            draw(&p, frameStartUs);
+        }
+
+        if (exporter.isRunning())
+        {
+            drawExportStatus(&p);
+            if ((exportFrame != nullptr) && (numExportFrames % exportFramesPerSecond == 0))
+                printExportStatus();
+        }
+    }
+    data->frameDrawn(frameStartUs, pcClockUs());
+
+    if (exporter.isRunning() && (maxExportFrames > 0) && (numExportFrames >= maxExportFrames))
+        stopExport();
+}
+
+/*
+ * Export what the widget shows to 'path' (see FrameExporter for formats). Frames are the size of the widget now.
+ * 'framesPerSecond' is that of the render timer if 0.
+ *
+ * On screen, every frame drawn is exported, at the render timer rate.  Offscreen, the simulator is advanced by
+ * one frame of virtual time per frame, as fast as frames can be drawn and written; the screen only shows progress.
+ * Arduino runs in real time, so there is no offscreen export while it is used.
+ */
+bool RenderWidget::startExport(const QString &path, int framesPerSecond, bool isOffscreen, int maxFrames)
+{
+    stopExport();
+
+    if (isOffscreen && data->useArduino)
+    {
+        printf("Export: offscreen export needs the simulator, not arduino\n");
+        return false;
+    }
+
+    if (framesPerSecond <= 0)
+        framesPerSecond = qMax(1, 1000 / data->timerInterval);
+
+    if (!exporter.start(path, FrameExporter::getFormatFromPath(path), size(), devicePixelRatioF(), framesPerSecond))
+    {
+        printf("Export: can't create %s\n", path.toLocal8Bit().constData());
+        return false;
+    }
+
+    isExportOffscreen = isOffscreen;
+    exportFramesPerSecond = framesPerSecond;
+    numExportFrames = 0;
+    maxExportFrames = maxFrames;
+
+    // exported frames are always drawn at full quality (frames aren't given to the governor while exporting).
+    data->qualityGovernor.reset();
+
+    if (isOffscreen)
+    {
+        timer->stop();
+        data->isRenderingOffscreen = true;
+        data->arduinoSimulator->setExternalClock(true);
+        exportTimer->start(0);
+    }
+
+    printf("Export: %s, %dx%d at %d fps%s\n", path.toLocal8Bit().constData(), int(width() * devicePixelRatioF()),
+           int(height() * devicePixelRatioF()), framesPerSecond, isOffscreen ? ", offscreen" : "");
+    return true;
+}
+
+void RenderWidget::stopExport()
+{
+    if (!exporter.isRunning())
+        return;
+
+    if (isExportOffscreen)
+    {
+        exportTimer->stop();
+        data->arduinoSimulator->setExternalClock(false);
+        data->isRenderingOffscreen = false;
+        timer->start(data->timerInterval);
+    }
+
+    exporter.stop();
+    printExportStatus();
+    update();
+
+    if (quitWhenExportStops)
+        QCoreApplication::quit();
+}
+
+bool RenderWidget::isExporting()
+{
+    return exporter.isRunning();
+}
+
+bool RenderWidget::isExportingOffscreen()
+{
+    return exporter.isRunning() && isExportOffscreen;
+}
+
+/*
+ * Export given on the command line. It starts once the widget is shown, with the size it has then (events of
+ * showing and resizing a window come together, the export starts after them), and the program quits when the
+ * export stops.
+ */
+void RenderWidget::startExportWhenShown(const QString &path, int framesPerSecond, bool isOffscreen, int maxFrames)
+{
+    pendingExportPath = path;
+    pendingExportFramesPerSecond = framesPerSecond;
+    isPendingExportOffscreen = isOffscreen;
+    pendingMaxExportFrames = maxFrames;
+
+    if (isVisible())
+        QTimer::singleShot(0, this, &RenderWidget::startPendingExport);
+}
+
+void RenderWidget::startPendingExport()
+{
+    if (pendingExportPath.isEmpty() || !isVisible() || size().isEmpty())
+        return;
+
+    QString path = pendingExportPath;
+    pendingExportPath.clear();
+
+    if (startExport(path, pendingExportFramesPerSecond, isPendingExportOffscreen, pendingMaxExportFrames))
+        quitWhenExportStops = true;
+    else
+        QCoreApplication::exit(1);
+}
+
+/*
+ * Offscreen export: one frame, one frame time later in virtual time.  If the writer is behind, the frame waits for
+ * it rather than being dropped.
+ */
+void RenderWidget::exportTimerEvent()
+{
+    if (!exporter.hasFreeFrame())
+        return;
+
+    data->arduinoSimulator->advanceVirtualTime(qint64(1e6 * data->arduinoSimulator->getTimeScale() / exportFramesPerSecond));
+
+    QImage *frame = exporter.acquireFrame();
+    drawFrame(frame, data->arduinoSimulator->getCurrentPcClockUs());
+    showInPresenterWindow(*frame);
+    exporter.submitFrame(frame);
+
+    if (++numExportFrames % exportFramesPerSecond == 0)
+    {
+        printExportStatus();
+        update();
+    }
+
+    if ((maxExportFrames > 0) && (numExportFrames >= maxExportFrames))
+        stopExport();
+}
+
+/*
+ * Presenter window mirrors the frames of this widget. It is created when first shown.
+ */
+void RenderWidget::setPresenterWindowVisible(bool isVisible)
+{
+    if (isVisible && (presenterWindow == nullptr))
+        presenterWindow = new PresenterWindow(this);
+
+    if (presenterWindow != nullptr)
+        presenterWindow->setVisible(isVisible);
+}
+
+/*
+ * Image to draw the frame into, for the presenter window or for rendering at less than the widget's resolution;
+ * nullptr if the frame can be drawn on the widget directly.  Images alternate, so that the one presenter window
+ * holds is never drawn into (which would make QImage copy it).
+ *
+ * At a reduced scale the image has a pixel ratio of its own, and whatever is cached per pixel ratio (labels,
+ * sprites, background) is rebuilt for it, so frames are drawn in fewer pixels rather than drawn and shrunk.
+ * While exporting, the scale is not reduced: frames the exporter has no room for are drawn at the pixel ratio of
+ * the exported ones, so that caches are not rebuilt back and forth.
+ */
+QImage *RenderWidget::getInternalFrame()
+{
+    int scalePercent = exporter.isRunning() ? 100 : qMin(data->renderScalePercent, 100);
+
+    bool isPresenterWindowVisible = (presenterWindow != nullptr) && presenterWindow->isVisible();
+    if (!isPresenterWindowVisible && (scalePercent == 100))
+        return nullptr;
+
+    QImage &frame = internalFrames[internalFrameIndex];
+    internalFrameIndex ^= 1;
+
+    qreal pixelRatio = devicePixelRatioF() * scalePercent / 100;
+    if ((frame.size() != size() * pixelRatio) || (frame.devicePixelRatioF() != pixelRatio))
+    {
+        frame = QImage(size() * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+        frame.setDevicePixelRatio(pixelRatio);
+    }
+    return &frame;
+}
+
+/*
+ * Presenter window gets a reference to the frame's pixels; nothing is copied.
+ */
+void RenderWidget::showInPresenterWindow(const QImage &frame)
+{
+    if ((presenterWindow != nullptr) && presenterWindow->isVisible())
+        presenterWindow->showFrame(frame);
+}
+
+void RenderWidget::drawFrame(QImage *frame, qint64 frameStartUs)
+{
+    frame->fill(palette().color(QPalette::Window));
+
+    QPainter p(frame);
+    draw(&p, frameStartUs);
+}
+
+/*
+ * On the widget only, never in the exported frames.
+ */
+void RenderWidget::drawExportStatus(QPainter *p)
+{
+    QFont font;
+    font.setPixelSize(13);
+    p->setFont(font);
+    p->setPen(QPen(QColor(200, 50, 50)));
+    p->setOpacity(0.6);
+    p->drawText(10, 20, QString("Exporting%1: %2 frames written, %3 dropped, %4 failed, queue %5 (max %6)")
+                        .arg(isExportOffscreen ? " offscreen" : "")
+                        .arg(exporter.getNumFramesWritten())
+                        .arg(exporter.getNumFramesDropped())
+                        .arg(exporter.getNumFramesFailed())
+                        .arg(exporter.getQueueDepth())
+                        .arg(exporter.getMaxQueueDepth()));
+    p->setOpacity(1);
+}
+
+void RenderWidget::printExportStatus()
+{
+    printf("Export: %d frames written, %d dropped, %d failed, queue %d (max %d of %d)\n", exporter.getNumFramesWritten(),
+           exporter.getNumFramesDropped(), exporter.getNumFramesFailed(), exporter.getQueueDepth(), exporter.getMaxQueueDepth(),
+           FRAME_EXPORT_POOL_SIZE);
+}
+
+
+void RenderWidget::draw(QPainter * p, qint64 frameStartUs)
+{
+    //----------------------------------------------------------------------------------------------------------
+    // Draw the vector where it is expected to be at this moment, not where it was when last reported.
+    // Decide if vector (arduino or simulator) is rotating. If it is rotating, and if current angle is 0, 90, 180
+    // and 270, it will be applied on current ordinate.
+    //----------------------------------------------------------------------------------------------------------
+    data->updateAngleForFrame(frameStartUs);
+    isVectorOrArduinoRunning = data->angleEstimator.isMoving(frameStartUs);
+    //----------------------------------------------------------------------------------------------------------
+
+    labels.update(p->device()->devicePixelRatioF());     // the widget's, or that of the image frame is drawn into
+
+    // leave out some detail if frames have been taking too long to draw
+    QualityGovernor::Level quality = data->qualityGovernor.getLevel();
+    projections.setDetail((quality >= QualityGovernor::DECIMATED_WAVE) ? 2 : 1,
+                          quality < QualityGovernor::NO_GUIDE_LINES);
+    projections.setWaveRasterizer(data->useWaveRasterizer);
+
+    QFont font;
+
+    VectorDrawingCoordinates v;
+
+    // Automatically set vector origin coords baseds on window width and height.  Then add offsets to it.
+    v.vector_origin_x = vectorOrigin.x();
+    v.vector_origin_y = vectorOrigin.y();
+
+    v.vector_width  = int(data->amplitude * cos(data->curAngleInRadians));
+    v.vector_height = int(data->amplitude * sin(data->curAngleInRadians));
+
+    v.vector_tip_x = v.vector_origin_x + v.vector_width;
+    v.vector_tip_y = v.vector_origin_y - v.vector_height;
+
+    v.xaxis_x = v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth/2;
+    v.xaxis_y = v.vector_origin_y;
+
+    v.yaxis_x = v.vector_origin_x;
+    v.yaxis_y = v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth/2;
+
+    v.vproj_origin_x = v.vector_origin_x - data->amplitude - wallSeparation;
+    v.vproj_origin_y = v.vector_origin_y;
+
+    v.hproj_origin_x = v.vector_origin_x;
+    v.hproj_origin_y = v.vector_origin_y - data->amplitude - wallSeparation;
+
+
+    drawAxis(p);
+    drawProjectionBoxes(p);
+
+    drawBackground(p, v);
+    drawSineAndCosinePoints(p);
+    drawLinesAtImportantOrdinateValues(p);
+
+    drawRotatingVectorComponents(p, v);
+    drawRotatingVector(p, v);
+    drawVectorProjection(p, v);
+
+    // For the projection tip circle to show correctly, draw this after drawing sin & cos points and vector projection dotted line.
+    drawTipCircles(p, v);
+
+    drawObservers(p);
+    drawQualityIndicator(p);
+}
+
+
+void RenderWidget::drawProjectionBoxes(QPainter *p)
+{
+    //-------------------------------------------------------------------
+    // Draw rectangle that will have the vector's vertical shadow
+    //-------------------------------------------------------------------
+    QFont font = QFont();
+    font.setPixelSize(13);
+//    font.setStretch(2.0);
+    p->setFont(font);
+    QFontMetrics fm(font);
+    QString str;
+    QPen pen;
+
+    if (data->showVerticalProjectionBox)
+    {
+        pen = QPen(QColor(100, 100, 100));
+        pen.setWidth(2);
+        pen.setCapStyle(Qt::RoundCap);
+        p->setPen(pen);
+        p->setOpacity(0.2);
+
+        xProjection->drawVectorProjectionBoxes(p, data->penWidth);
+
+        p->setOpacity(1);
+
+        //---------------------------------------------------------
+//        font.setPixelSize(20);
+//        p->setFont(font);
+//        p->drawText(v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth - 25,
+//                    v.vector_origin_y - data->amplitude - 5,
+//                    "+1");
+//        p->drawText(v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth - 18,
+//                    v.vector_origin_y + data->amplitude + 20,
+//                    "-1");
+
+    }
+
+    //-------------------------------------------------------------------
+    // Draw rectangle that will have the vector's horizontal projection (not shadow. no vector casting horizontal shadow)
+    //-------------------------------------------------------------------
+    pen.setColor(QColor(150,150,150));
+    p->setPen(pen);
+
+    if (data->showHorizontalProjectionBox)
+    {
+        pen = QPen(QColor(100, 100, 100));
+        pen.setWidth(2);
+        pen.setCapStyle(Qt::RoundCap);
+        p->setPen(pen);
+        p->setOpacity(0.2);
+
+        yProjection->drawVectorProjectionBoxes(p, data->penWidth);
+
+        p->setOpacity(1);
+
+        //---------------------------------------------------------
+//        p->drawText(v.vector_origin_x - data->amplitude - 23,
+//                    v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth,
+//                    "-1");
+//        p->drawText(v.vector_origin_x + data->amplitude + 3,
+//                    v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth,
+//                    "+1");
+    }
+
+}
+
+void RenderWidget::drawBackground(QPainter *p, VectorDrawingCoordinates v)
+{
+    if (data->showScrollingBackgroundText && (data->qualityGovernor.getLevel() < QualityGovernor::NO_SCROLLING_BACKGROUND))
+    {
+        //--------------------------------------------------------------------
+        // Draw Horizontal background
+        //--------------------------------------------------------------------
+        QFont font = QFont();
+        font.setPixelSize(30);
+        QPen pen = QPen(scrollingBackgroundColor);
+        p->setPen(pen);
+        p->setBrush(Qt::green);
+        p->setFont(font);
+
+        if (data->showSinOnXAxis)
+        {
+            p->setOpacity(0.2);
+
+            hzScrollingBackground.draw(*p,
+                                       0,                                               // x offset
+                                       v.vector_origin_y - data->amplitude,             // y offset
+                                       v.vector_origin_x - data->amplitude,             // width of rectangle to draw in
+                                       data->amplitude * 2                              // height of rectangle to draw in
+            );
+
+            if (!data->isTimePaused)
+                hzScrollingBackground.shiftLeft(data->timeXInc);
+
+            pen = QPen(cosColor);
+            p->setPen(pen);
+            p->setBrush(sinColor);
+            p->setOpacity(0.05);
+            p->drawRect(0,
+                        v.vector_origin_y - data->amplitude - wallSeparation,
+                        v.vector_origin_x - data->amplitude - wallSeparation - data->penWidth/2,
+                        2 * (data->amplitude + wallSeparation));
+
+            p->setOpacity(1);
+        }
+
+        if (data->showCosOnYAxis)
+        {
+            //--------------------------------------------------------------------
+            // Draw Vertical background
+            //--------------------------------------------------------------------
+            pen = QPen(scrollingBackgroundColor);
+            p->setPen(pen);
+            p->setOpacity(0.2);
+
+            vtScrollingBackground.draw(*p,
+                                       v.vector_origin_x - data->amplitude,               // x offset
+                                       0,                                                 // y offset
+                                       data->amplitude * 2,                               // width of rectangle to draw in
+                                       v.vector_origin_y - data->amplitude                // height of rectangle to draw in
+            );
+
+            if (!data->isTimePaused)
+                vtScrollingBackground.shiftUp(data->timeXInc);
+
+            pen = QPen(cosColor);
+            p->setPen(pen);
+            p->setBrush(cosColor);
+            p->setOpacity(0.05);
+            p->drawRect(v.vector_origin_x - data->amplitude - wallSeparation,
+                        0,
+                        2 * (data->amplitude + wallSeparation),
+                        v.vector_origin_y - data->amplitude - wallSeparation - data->penWidth/2);
+            p->setOpacity(1);
+        }
+    }
+}
+
+void RenderWidget::drawRotatingVectorComponents(QPainter *p, VectorDrawingCoordinates v)
+{
+    if (data->drawSinComponent)
+    {
+        // Drop a line from vector tip perpendicular to X axis
+        xProjection->drawVectorComponentInVectorSweepCircle(p, data->curAngleInDegrees, data->penWidth);
+
+        for (Projection *projection : threePhaseProjections)
+            projection->drawVectorComponentInVectorSweepCircle(p, data->curAngleInDegrees, data->penWidth);
+    }
+
+    if (data->drawCosComponent)
+    {
+        // Draw a line from vector tip perpendicular to the axis of current phase
+        yProjection->drawVectorComponentInVectorSweepCircle(p, data->curAngleInDegrees, data->penWidth);
+    }
+    p->setOpacity(1);
+}
+
+
+void RenderWidget::drawRotatingVector(QPainter *p, VectorDrawingCoordinates v)
+{
+    //--------------------------------------------------------------------
+    // Draw rotating vector, if enabled
+    //--------------------------------------------------------------------
+    if (data->drawRotatingVector)
+    {
+        //----------------------------------------------------
+        // Draw vector x & y axis and tracing circle
+        QPen pen = QPen(QColor(120, 120, 120));
+        pen.setWidth(2);
+        pen.setCapStyle(Qt::RoundCap);
+        p->setPen(pen);
+        p->setBrush(vectorSweepColor);
+        p->setOpacity(0.1);
+        p->drawEllipse(v.vector_origin_x - data->amplitude,
+                       v.vector_origin_y - data->amplitude,
+                       2 * data->amplitude,
+                       2 * data->amplitude
+        );
+
+        p->setOpacity(0.3);
+        xProjection->drawLineThroughVectorSweepCircle(p);
+        yProjection->drawLineThroughVectorSweepCircle(p);
+
+        if (data->phaseShiftArcAndCaption)
+            yProjection->drawPhaseArcFromGivenPhase(p, xProjection->phase, data->penWidth);
+
+        //----------------------------------------------------
+        // Draw vector itself.
+        pen = QPen(vectorColor);
+        pen.setWidth(data->penWidth);
+        pen.setCapStyle(Qt::RoundCap);
+        p->setPen(pen);
+        p->setBrush(vectorColor);
+        p->setOpacity(1);
+        p->drawLine(v.vector_origin_x,
+                    v.vector_origin_y,
+                    v.vector_tip_x,
+                    v.vector_tip_y
+        );
+
+        //----------------------------------------------------
+        // Draw arc showing the region from 0 degrees that forms the current angle.
+        if (data->drawAngleArc)
+        {
+            pen = QPen(Qt::black);
+            pen.setWidth(2);
+            pen.setCapStyle(Qt::RoundCap);
+            p->setPen(pen);
+            p->setBrush(vectorColor);
+            p->setOpacity(0.3);
+
+            int arcRadius = data->amplitude / 10;
+            p->drawArc(v.vector_origin_x - arcRadius,
+                       v.vector_origin_y - arcRadius,
+                       2 * arcRadius,
+                       2 * arcRadius,
+                       0 * 16,
+                       int(data->curAngleInDegrees * 16)
+            );
+
+            p->setOpacity(0.7);
+
+            QString angleString = QString::number(int(round(data->curAngleInDegrees))) + "°";
+            int w = labels.getStringWidth(LabelAtlas::ANGLE_READOUT_GLYPH, angleString);
+
+            labels.drawString(p,
+                              v.vector_origin_x - w/2,
+                              v.vector_origin_y + data->amplitude + 60,
+                              LabelAtlas::ANGLE_READOUT_GLYPH,
+                              angleString);
+        }
+    }
+
+}
+
+void RenderWidget::drawVectorProjection(QPainter *p, VectorDrawingCoordinates v)
+{
+    QPen pen = QPen();
+    pen.setWidth(1);
+    pen.setCapStyle(Qt::RoundCap);
+    p->setOpacity(0.7);
+
+    //--------------------------------------------------------------------
+    // VerticalpProjection
+    //--------------------------------------------------------------------
+    if (data->drawVerticalShadow)
+    {
+        pen.setColor(sinColor);
+        p->setPen(pen);
+        p->setBrush(sinColor);
+        xProjection->drawVectorProjection(p, data->curAngleInDegrees, data->penWidth);
+    }
+
+    //--------------------------------------------------------------------
+    // Horizontal projection
+    //--------------------------------------------------------------------
+    if (data->drawHorizontalShadow)
+    {
+        pen.setColor(cosColor);
+        p->setPen(pen);
+        p->setBrush(cosColor);
+        yProjection->drawVectorProjection(p, data->curAngleInDegrees, data->penWidth);
+    }
+    p->setOpacity(1);
+
+    //--------------------------------------------------------------------
+    // Dotted line showing projection
+    //--------------------------------------------------------------------
+    pen = QPen(QColor(20, 20, 20));
+    pen.setWidth(5);
+    pen.setStyle(Qt::DotLine);
+    p->setPen(pen);
+    p->setOpacity(0.1);
+
+    if (data->drawVerticalProjectionDottedLine)
+    {
+        // For vertical projection: from wall to vector tip.
+        xProjection->drawDottedLineFromVectorTip(p, data->curAngleInDegrees, v.vector_tip_x, v.vector_tip_y);
+    }
+
+    if (data->drawHorizontalProjectionDottedLine)
+    {
+        // For horizontal projection: from ceiling to vector tip.
+        yProjection->drawDottedLineFromVectorTip(p, data->curAngleInDegrees, v.vector_tip_x, v.vector_tip_y);
+    }
+    p->setOpacity(1);
+}
+
+void RenderWidget::drawSineAndCosinePoints(QPainter *p)
+{
+//    printf("smoothedChangeInAngle = %lf\n", smoothedChangeInAngle);
+    if (!data->isTimePaused)
+    {
+        // Feed all projection axis
+        projections.addSample(data->curAngleInDegrees,
+                              isVectorOrArduinoRunning,
+                              !data->arduinoSimulator->isCounterClockwise());
+    }
+
+    //--------------------------------------------------------------------
+    // Draw sine points, and the other two phases on the same axis for three phase demo.
+    //--------------------------------------------------------------------
+    if (data->showSinOnXAxis)
+    {
+        xProjection->drawWave(p, data->timeXInc, data->penWidth);
+
+        for (Projection *projection : threePhaseProjections)
+            projection->drawWave(p, data->timeXInc, data->penWidth, 0);
+    }
+
+    //--------------------------------------------------------------------
+    // Draw cosine points
+    //--------------------------------------------------------------------
+    if (data->showCosOnYAxis)
+    {
+        yProjection->drawWave(p, data->timeXInc, data->penWidth);
+        if (data->showAnglesOnXAndYAxis)
+            yProjection->drawAngles(p, labels, data->timeXInc, data->show30And60Angles, data->showAngleInRadians);
+    }
+
+    //--------------------------------------------------------------------
+    // Draw cosine on X axis along with sine so as to compare the 90 degree phase shift.
+    if (data->showCosOnXAxis)
+    {
+        yProjection->drawWave(p, data->timeXInc, data->penWidth, 0);
+    }
+
+    // Draw angles after potentially drawing Cosine on X axis. This will ensure the marks and angles are on top of sine & cosine lines.
+    if (data->showSinOnXAxis)
+    {
+        if (data->showAnglesOnXAndYAxis)
+            xProjection->drawAngles(p, labels, data->timeXInc, data->show30And60Angles, data->showAngleInRadians);
+    }
+    p->setOpacity(1);
+}
+
+
+void RenderWidget::drawLinesAtImportantOrdinateValues (QPainter *p)
+{
+    QPen pen = QPen(QColor(50, 50, 50));
+    pen.setWidth(2);
+    p->setPen(pen);
+
+
+    if (data->showSinOnXAxis)
+    {
+        if (data->showAllOrdinates)
+            xProjection->drawLinesAtImportantCoordinates(p, labels, true, true, true, true,
+                                                                 data->showOrdinateCaptions,
+                                                                 data->showOrdinateCaptions,
+                                                                 data->showOrdinateCaptions,
+                                                                 data->showOrdinateCaptions);
+        else
+        {
+            if (data->show1AndMinus1Ordinates)
+                xProjection->drawLinesAtImportantCoordinates(p, labels, true, false, false, false,
+                                                                     data->showOrdinateCaptions,
+                                                                     data->showOrdinateCaptions,
+                                                                     data->showOrdinateCaptions,
+                                                                     data->showOrdinateCaptions);
+        }
+    }
+
+    if (data->showCosOnYAxis)
+    {
+        if (data->showAllOrdinates)
+            yProjection->drawLinesAtImportantCoordinates(p, labels, true, true, true, true,
+                                                                 data->showOrdinateCaptions,
+                                                                 data->showOrdinateCaptions,
+                                                                 data->showOrdinateCaptions,
+                                                                 data->showOrdinateCaptions);
+        else
+        {
+            if (data->show1AndMinus1Ordinates)
+                yProjection->drawLinesAtImportantCoordinates(p, labels, true, false, false, false,
+                                                                     data->showOrdinateCaptions,
+                                                                     data->showOrdinateCaptions,
+                                                                     data->showOrdinateCaptions,
+                                                                     data->showOrdinateCaptions);
+        }
+    }
+}
+
+
+void RenderWidget::drawTipCircles(QPainter *p, VectorDrawingCoordinates v)
+{
+    QPen pen = QPen(vectorTipCircleColor);
+    pen.setWidth(2);
+    pen.setCapStyle(Qt::RoundCap);
+    p->setPen(pen);
+    p->setBrush(Qt::white);
+    p->setOpacity(1);
+
+    if (data->drawRotatingVector)
+    {
+        // Draw a circle at the tip of the vector
+        p->drawEllipse(v.vector_tip_x - data->penWidth / 2,
+                       v.vector_tip_y - data->penWidth / 2,
+                       data->penWidth,
+                       data->penWidth);
+    }
+    if (data->drawVerticalProjectionTipCircle)
+    {
+        xProjection->drawTipCircle(p, data->curAngleInDegrees, data->penWidth);      // Draw a circle at the tip of the vector's vertical projection
+
+        for (Projection *projection : threePhaseProjections)
+            projection->drawTipCircleWithoutRotation(p, data->curAngleInDegrees, data->penWidth);
+    }
+
+    if (data->drawHorizontalProjectionTipCircle && data->drawHorizontalShadow)
+        yProjection->drawTipCircle(p, data->curAngleInDegrees, data->penWidth);      // Draw a circle at the tip of the vector's horizontal projection
+
+    if (data->showCosOnXAxis && data->drawHorizontalProjectionTipCircle)
+        yProjection->drawTipCircleWithoutRotation(p, data->curAngleInDegrees, data->penWidth);
+
+    p->setOpacity(1);
+}
+
+void RenderWidget::drawAxis(QPainter *p)
+{
+    //-------------------------------------------------------------------
+    // Draw X & Y axis
+    //--------------------------------------------------------------------
+    QPen pen = QPen(QColor(80, 80, 80));
+    pen.setWidth(2);
+    pen.setCapStyle(Qt::RoundCap);
+    p->setPen(pen);
+    p->setOpacity(0.7);
+
+    if (data->showSinOnXAxis)
+        xProjection->drawAxis(p);
+
+    if (data->showCosOnYAxis)
+        yProjection->drawAxis(p);
+}
+
+void RenderWidget::drawObservers(QPainter *p)
+{
+    xProjection->drawObserver(p);
+    yProjection->drawObserver(p);
+}
+
+/*
+ * Tell audience (and presenter) that some detail is left out to keep the waves moving smoothly.
+ */
+void RenderWidget::drawQualityIndicator(QPainter *p)
+{
+    if (data->qualityGovernor.getLevel() == QualityGovernor::FULL_QUALITY)
+        return;
+
+    QFont font;
+    font.setPixelSize(13);
+    p->setFont(font);
+    p->setPen(QPen(QColor(200, 50, 50)));
+    p->setOpacity(0.6);
+    p->drawText(10, height() - 10, data->qualityGovernor.getLevelDescription());
+    p->setOpacity(1);
+}
@@ -1,264 +1,327 @@
-#ifndef RENDERWIDGET_H
-#define RENDERWIDGET_H
-
-#include <QWidget>
-#include <QRandomGenerator>
-#include <QPainter>
-#include <QTimer>
-#include <tuple>
-#include <QDir>
-#include <QFile>
-#include <projection.h>
-
-
-using namespace std;
-
-#define NUM_ORDINATES                   2300
-#define NUM_BACKGROUND_TEXT_POINTS      15
-#define NUM_TIME_TEXT_POINTS            8
-#define NUM_ANGLE_TEXT_POINTS           8
-
-
-class MainWindow;
-
-
-/*************************************************************************************************
-
- *************************************************************************************************/
-struct BackgroundText
-{
-    int *x;
-    int *y;
-    QString text;
-    int numPoints;
-
-    int maxX;
-    int maxY;
-
-public:
-    BackgroundText(QString text_, int numPoints_) :
-        x(nullptr),
-        y(nullptr),
-        text(text_),
-        numPoints(numPoints_),
-        maxX(0),
-        maxY(0)
-    {
-        x = new int[numPoints];
-        y = new int[numPoints];
-    }
-    void genRandomPoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
-    {
-        this->maxX = maxX;
-        this->maxY = maxY;
-
-        for (int i=0; i<numPoints; i++)
-        {
-            x[i] = randomGenerator.bounded(minX, maxX);
-            y[i] = randomGenerator.bounded(minY, maxY);
-        }
-    }
-
-    void draw(QPainter &p, int xOffset, int yOffset, int width, int height)
-    {
-        for (int i=0; i<numPoints; i++)
-        {
-            if ((x[i] < width) && (y[i] < height))
-            {
-                p.drawText(xOffset + x[i], yOffset + y[i], text);
-            }
-        }
-    }
-
-    void shiftLeft(int amount)
-    {
-        for (int i=0; i<numPoints; i++)
-        {
-            x[i] -= amount;
-            if (x[i] < -200)
-            {
-                x[i] = maxX;
-            }
-        }
-    }
-
-    void shiftUp(int amount)
-    {
-        for (int i=0; i<numPoints; i++)
-        {
-            y[i] -= amount;
-            if (y[i] < 0)
-            {
-                y[i] = maxY;
-            }
-        }
-    }
-
-};
-
-
-/*************************************************************************************************
-
- *************************************************************************************************/
-struct ScrollingBackground
-{
-public:
-    BackgroundText backgroundText;
-    BackgroundText timeText;
-    BackgroundText angleText;
-
-    ScrollingBackground(int numBackgroundTextPoints, int numTimeTextPoints, int numAngleTextPoints) :
-        backgroundText(BackgroundText("Background", numBackgroundTextPoints)),
-        timeText(BackgroundText("Time", numTimeTextPoints)),
-        angleText(BackgroundText("Angle", numAngleTextPoints))
-    {
-    }
-
-    void generateRandomBackgroundPoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
-    {
-        backgroundText.genRandomPoints(minX, maxX, minY, maxY, randomGenerator);
-    }
-    void generateRandomTimePoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
-    {
-        timeText.genRandomPoints(minX, maxX, minY, maxY, randomGenerator);
-    }
-    void generateRandomAnglePoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
-    {
-        angleText.genRandomPoints(minX, maxX, minY, maxY, randomGenerator);
-    }
-
-    void draw(QPainter &p, int xOffset, int yOffset, int width, int height)
-    {
-        backgroundText.draw(p, xOffset, yOffset, width, height);
-        timeText.draw(p, xOffset, yOffset, width, height);
-        angleText.draw(p, xOffset, yOffset, width, height);
-    }
-
-    void shiftLeft(int amount)
-    {
-        backgroundText.shiftLeft(amount);
-        timeText.shiftLeft(amount);
-        angleText.shiftLeft(amount);
-    }
-
-    void shiftUp(int amount)
-    {
-        backgroundText.shiftUp(amount);
-        timeText.shiftUp(amount);
-        angleText.shiftUp(amount);
-    }
-};
-
-
-struct VectorDrawingCoordinates
-{
-    int vector_origin_x;
-    int vector_origin_y;
-
-    int vector_width;
-    int vector_height;
-
-    int vector_tip_x;
-    int vector_tip_y;
-
-    // coordinates of rightmost point of the X axis
-    int xaxis_x;
-    int xaxis_y;
-
-    // coordinates of the bottommost point of the Y axis
-    int yaxis_x;
-    int yaxis_y;
-
-    // coordinates of the vector origin's vertical projection
-    int vproj_origin_x;
-    int vproj_origin_y;
-
-    // coordinates of the vector origin's horizontal projection
-    int hproj_origin_x;
-    int hproj_origin_y;
-};
-
-
-/*************************************************************************************************
-
- *************************************************************************************************/
-class RenderWidget : public QWidget
-{
-    Q_OBJECT
-public:
-    explicit RenderWidget(QWidget *parent = nullptr, MainWindow *data = nullptr);
-    void updateTimerInterval();
-    void clearSinOrdinates();
-    void clearCosOrdinates();
-    void recalculateVectorOrigin();
-    void notifyPositionChange();
-    void updatePhaseShiftFromSine();
-
-protected:
-    void resizeEvent(QResizeEvent* event);
-
-
-public slots:
-    void renderTimerEvent();
-
-signals:
-
-
-protected:
-    void paintEvent(QPaintEvent *pe);
-
-
-private:
-    void draw                               (QPainter *p);
-    void drawProjectionBoxes                (QPainter *p);
-    void drawBackground                     (QPainter *p, VectorDrawingCoordinates v);
-    void drawRotatingVectorComponents       (QPainter *p, VectorDrawingCoordinates v);
-    void drawRotatingVector                 (QPainter *p, VectorDrawingCoordinates v);
-    void drawVectorProjection               (QPainter *p, VectorDrawingCoordinates v);
-    void drawAxis                           (QPainter *p);
-    void drawSineAndCosinePoints            (QPainter *p);
-    void drawLinesAtImportantOrdinateValues (QPainter *p);
-    void drawTipCircles                     (QPainter *p, VectorDrawingCoordinates v);
-    void drawObservers                      (QPainter *p);
-
-    void lowPassFilterAngleDifference(double difference);
-
-    QTimer *timer = new QTimer(this);
-
-    MainWindow *data;
-
-
-    ScrollingBackground vtScrollingBackground = ScrollingBackground(NUM_BACKGROUND_TEXT_POINTS/2,
-                                                                    NUM_TIME_TEXT_POINTS/2,
-                                                                    NUM_ANGLE_TEXT_POINTS/2);
-
-    ScrollingBackground hzScrollingBackground = ScrollingBackground(NUM_BACKGROUND_TEXT_POINTS,
-                                                                    NUM_TIME_TEXT_POINTS,
-                                                                    NUM_ANGLE_TEXT_POINTS);
-
-    QImage *aliceImage = nullptr;
-    QImage *catImage = nullptr;
-
-    const QColor sinColor = QColor(120, 220, 120);
-    const QColor cosColor = QColor(140, 190, 255);
-
-    const QColor vectorColor = QColor(0, 220, 220);
-    const QColor vectorTipCircleColor = QColor(40, 40, 40);
-    const QColor vectorSweepColor = QColor(0, 50, 50);
-    const QColor scrollingBackgroundColor = QColor(150, 150, 150);
-
-    const int wallSeparation = 30;
-    const double sinCosOpacity = 0.7;
-
-    double previousAngleInDegrees = 0;
-    double smoothedChangeInAngle = 0;
-    bool isVectorOrArduinoRunning = false;      // decides whether angle (0, 90, 180, 270) is set on an ordinate.
-
-    QPoint vectorOrigin = QPoint(0, 0);
-
-    Projection xProjection = Projection(0, NUM_ORDINATES, "alice.png", sinColor);
-    Projection yProjection = Projection(0, NUM_ORDINATES, "cat.png", cosColor);
-
-};
-
-#endif // RENDERWIDGET_H
+#ifndef RENDERWIDGET_H
+#define RENDERWIDGET_H
+
+#include <QWidget>
+#include <QRandomGenerator>
+#include <QPainter>
+#include <QPixmap>
+#include <QFontMetrics>
+#include <QTimer>
+#include <tuple>
+#include <QDir>
+#include <QFile>
+#include <projection.h>
+#include "projectionset.h"
+#include "labelatlas.h"
+#include "frameexporter.h"
+#include "presenterwindow.h"
+
+
+using namespace std;
+
+#define NUM_BACKGROUND_TEXT_POINTS      15
+#define NUM_TIME_TEXT_POINTS            8
+#define NUM_ANGLE_TEXT_POINTS           8
+
+
+class MainWindow;
+
+
+/*************************************************************************************************
+ Words ("Background", "Time", "Angle") scattered over the background of a wave, scrolling with it.
+
+ Positions of all the words are kept in arrays of their own (structure of arrays), so that scrolling
+ is a tight loop over ints which the compiler vectorizes.  Each word is rendered once into a sprite,
+ in the pen color and font of the painter; a frame draws all visible words in one call.
+ *************************************************************************************************/
+struct ScrollingBackground
+{
+    enum Word { BACKGROUND_WORD, TIME_WORD, ANGLE_WORD, NUM_WORDS };
+
+    int numPoints[NUM_WORDS];
+
+    // one element per scattered word
+    vector<int> x;
+    vector<int> y;
+    vector<int> wrapX;          // where a word goes when it scrolls off the left edge
+    vector<int> wrapY;          // where a word goes when it scrolls off the top edge
+    vector<int> word;
+
+    // sprites of the words one below the other, at device pixel ratio
+    QPixmap sprites;
+    QRect spriteRects[NUM_WORDS];           // device pixels
+    QPointF spriteCenters[NUM_WORDS];       // center of sprite relative to the point text would be drawn at
+    QColor spriteColor;
+    int spriteFontPixelSize = 0;
+    qreal spritePixelRatio = 0;
+
+    vector<QPainter::PixmapFragment> fragments;
+
+public:
+    ScrollingBackground(int numBackgroundTextPoints, int numTimeTextPoints, int numAngleTextPoints)
+    {
+        numPoints[BACKGROUND_WORD] = numBackgroundTextPoints;
+        numPoints[TIME_WORD] = numTimeTextPoints;
+        numPoints[ANGLE_WORD] = numAngleTextPoints;
+    }
+
+    void generateRandomBackgroundPoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
+    {
+        genRandomPoints(BACKGROUND_WORD, minX, maxX, minY, maxY, randomGenerator);
+    }
+    void generateRandomTimePoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
+    {
+        genRandomPoints(TIME_WORD, minX, maxX, minY, maxY, randomGenerator);
+    }
+    void generateRandomAnglePoints(int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
+    {
+        genRandomPoints(ANGLE_WORD, minX, maxX, minY, maxY, randomGenerator);
+    }
+
+    void genRandomPoints(Word w, int minX, int maxX, int minY, int maxY, QRandomGenerator &randomGenerator)
+    {
+        for (int i=0; i<numPoints[w]; i++)
+        {
+            x.push_back(randomGenerator.bounded(minX, maxX));
+            y.push_back(randomGenerator.bounded(minY, maxY));
+            wrapX.push_back(maxX);
+            wrapY.push_back(maxY);
+            word.push_back(w);
+        }
+    }
+
+    void updateSprites(QPainter &p)
+    {
+        QColor color = p.pen().color();
+        int fontPixelSize = p.font().pixelSize();
+        qreal pixelRatio = p.device()->devicePixelRatioF();
+
+        if ((color == spriteColor) && (fontPixelSize == spriteFontPixelSize) && (pixelRatio == spritePixelRatio))
+            return;
+
+        const char *words[NUM_WORDS] = { "Background", "Time", "Angle" };
+        QFontMetrics fm(p.font());
+        int spriteWidth = 0;
+        int spriteHeight = fm.height() + 2;
+
+        for (int w=0; w<NUM_WORDS; w++)
+            spriteWidth = std::max(spriteWidth, fm.horizontalAdvance(words[w]) + 2);
+
+        QImage image(QSize(spriteWidth, NUM_WORDS * spriteHeight) * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(pixelRatio);
+        image.fill(Qt::transparent);
+        {
+            QPainter sp(&image);
+            sp.setFont(p.font());
+            sp.setPen(color);
+
+            for (int w=0; w<NUM_WORDS; w++)
+            {
+                int width = fm.horizontalAdvance(words[w]) + 2;
+                sp.drawText(1, w * spriteHeight + 1 + fm.ascent(), words[w]);
+
+                spriteRects[w] = QRect(0, int(w * spriteHeight * pixelRatio), int(width * pixelRatio), int(spriteHeight * pixelRatio));
+                spriteCenters[w] = QPointF(width / 2.0 - 1, spriteHeight / 2.0 - 1 - fm.ascent());
+            }
+        }
+        sprites = QPixmap::fromImage(image);
+
+        spriteColor = color;
+        spriteFontPixelSize = fontPixelSize;
+        spritePixelRatio = pixelRatio;
+    }
+
+    void draw(QPainter &p, int xOffset, int yOffset, int width, int height)
+    {
+        updateSprites(p);
+
+        fragments.clear();
+        for (size_t i=0; i<x.size(); i++)
+        {
+            if ((x[i] < width) && (y[i] < height))
+            {
+                int w = word[i];
+                QPointF center(xOffset + x[i] + spriteCenters[w].x(), yOffset + y[i] + spriteCenters[w].y());
+
+                fragments.push_back(QPainter::PixmapFragment::create(center, spriteRects[w], 1 / spritePixelRatio, 1 / spritePixelRatio));
+            }
+        }
+        p.drawPixmapFragments(fragments.data(), int(fragments.size()), sprites);
+    }
+
+    void shiftLeft(int amount)
+    {
+        int *px = x.data();
+        const int *pWrap = wrapX.data();
+        int n = int(x.size());
+
+        for (int i=0; i<n; i++)
+        {
+            int shifted = px[i] - amount;
+            int wrapped = pWrap[i];             // loaded unconditionally, so that the loop has no branches
+            px[i] = (shifted < -200) ? wrapped : shifted;
+        }
+    }
+
+    void shiftUp(int amount)
+    {
+        int *py = y.data();
+        const int *pWrap = wrapY.data();
+        int n = int(y.size());
+
+        for (int i=0; i<n; i++)
+        {
+            int shifted = py[i] - amount;
+            int wrapped = pWrap[i];             // loaded unconditionally, so that the loop has no branches
+            py[i] = (shifted < 0) ? wrapped : shifted;
+        }
+    }
+};
+
+
+struct VectorDrawingCoordinates
+{
+    int vector_origin_x;
+    int vector_origin_y;
+
+    int vector_width;
+    int vector_height;
+
+    int vector_tip_x;
+    int vector_tip_y;
+
+    // coordinates of rightmost point of the X axis
+    int xaxis_x;
+    int xaxis_y;
+
+    // coordinates of the bottommost point of the Y axis
+    int yaxis_x;
+    int yaxis_y;
+
+    // coordinates of the vector origin's vertical projection
+    int vproj_origin_x;
+    int vproj_origin_y;
+
+    // coordinates of the vector origin's horizontal projection
+    int hproj_origin_x;
+    int hproj_origin_y;
+};
+
+
+/*************************************************************************************************
+
+ *************************************************************************************************/
+class RenderWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit RenderWidget(QWidget *parent = nullptr, MainWindow *data = nullptr);
+    void updateTimerInterval();
+    void clearSinOrdinates();
+    void clearCosOrdinates();
+    void recalculateVectorOrigin();
+    void notifyPositionChange();
+    void updatePhaseShiftFromSine();
+    void updateThreePhase();
+    bool startExport(const QString &path, int framesPerSecond, bool isOffscreen, int maxFrames);
+    void startExportWhenShown(const QString &path, int framesPerSecond, bool isOffscreen, int maxFrames);
+    void stopExport();
+    bool isExporting();
+    bool isExportingOffscreen();
+    void setPresenterWindowVisible(bool isVisible);
+
+protected:
+    void resizeEvent(QResizeEvent* event);
+    void showEvent(QShowEvent *event);
+
+
+public slots:
+    void renderTimerEvent();
+    void exportTimerEvent();
+    void startPendingExport();
+
+signals:
+
+
+protected:
+    void paintEvent(QPaintEvent *pe);
+
+
+private:
+    void draw                               (QPainter *p, qint64 frameStartUs);
+    void drawFrame                          (QImage *frame, qint64 frameStartUs);
+    void drawExportStatus                   (QPainter *p);
+    void printExportStatus                  ();
+    QImage *getInternalFrame                ();
+    void showInPresenterWindow              (const QImage &frame);
+    void drawProjectionBoxes                (QPainter *p);
+    void drawBackground                     (QPainter *p, VectorDrawingCoordinates v);
+    void drawRotatingVectorComponents       (QPainter *p, VectorDrawingCoordinates v);
+    void drawRotatingVector                 (QPainter *p, VectorDrawingCoordinates v);
+    void drawVectorProjection               (QPainter *p, VectorDrawingCoordinates v);
+    void drawAxis                           (QPainter *p);
+    void drawSineAndCosinePoints            (QPainter *p);
+    void drawLinesAtImportantOrdinateValues (QPainter *p);
+    void drawTipCircles                     (QPainter *p, VectorDrawingCoordinates v);
+    void drawObservers                      (QPainter *p);
+    void drawQualityIndicator               (QPainter *p);
+    int  getNumSamplesToFill                ();
+
+    QTimer *timer = new QTimer(this);
+
+    MainWindow *data;
+
+
+    ScrollingBackground vtScrollingBackground = ScrollingBackground(NUM_BACKGROUND_TEXT_POINTS/2,
+                                                                    NUM_TIME_TEXT_POINTS/2,
+                                                                    NUM_ANGLE_TEXT_POINTS/2);
+
+    ScrollingBackground hzScrollingBackground = ScrollingBackground(NUM_BACKGROUND_TEXT_POINTS,
+                                                                    NUM_TIME_TEXT_POINTS,
+                                                                    NUM_ANGLE_TEXT_POINTS);
+
+    QImage *aliceImage = nullptr;
+    QImage *catImage = nullptr;
+
+    const QColor sinColor = QColor(120, 220, 120);
+    const QColor cosColor = QColor(140, 190, 255);
+    const QColor threePhaseColors[2] = { QColor(250, 170, 90), QColor(220, 130, 220) };
+
+    const QColor vectorColor = QColor(0, 220, 220);
+    const QColor vectorTipCircleColor = QColor(40, 40, 40);
+    const QColor vectorSweepColor = QColor(0, 50, 50);
+    const QColor scrollingBackgroundColor = QColor(150, 150, 150);
+
+    const int wallSeparation = 30;
+    const double sinCosOpacity = 0.7;
+
+    bool isVectorOrArduinoRunning = false;      // decides whether angle (0, 90, 180, 270) is set on an ordinate.
+
+    QPoint vectorOrigin = QPoint(0, 0);
+
+    ProjectionSet projections{1};                   // sized to the widget on resize
+    Projection *xProjection = projections.add(0, ":/alice.png", sinColor);
+    Projection *yProjection = projections.add(0, ":/cat.png", cosColor);
+    vector<Projection*> threePhaseProjections;      // other two phases, drawn on X axis along with sine
+
+    LabelAtlas labels;
+
+    FrameExporter exporter;
+    QTimer *exportTimer = new QTimer(this);         // drives offscreen export
+    bool isExportOffscreen = false;
+    int exportFramesPerSecond = 0;
+    int numExportFrames = 0;                        // submitted to the exporter
+    int maxExportFrames = 0;                        // export stops after these many frames, 0 if it doesn't
+    QString pendingExportPath;                      // export to start once shown, empty if none
+    int pendingExportFramesPerSecond = 0;
+    bool isPendingExportOffscreen = false;
+    int pendingMaxExportFrames = 0;
+    bool quitWhenExportStops = false;               // export was given on the command line
+
+    PresenterWindow *presenterWindow = nullptr;
+    QImage internalFrames[2];                       // one is drawn into while presenter window shows the other
+    int internalFrameIndex = 0;
+
+};
+
+#endif // RENDERWIDGET_H
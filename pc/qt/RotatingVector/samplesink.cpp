@@ -0,0 +1,12 @@
+#include "samplesink.h"
+#include <QElapsedTimer>
+
+qint64 pcClockUs()
+{
+    static QElapsedTimer clock;
+
+    if (!clock.isValid())
+        clock.start();
+
+    return clock.nsecsElapsed() / 1000;
+}
@@ -0,0 +1,45 @@
+#ifndef SAMPLESINK_H
+#define SAMPLESINK_H
+
+#include <QtGlobal>
+
+/*
+ * Position of the vector reported by a sample source (arduino, simulator or replay).
+ */
+struct AngleSample
+{
+    qint64 timestampUs;             // when the position was reached, in the clock of the source. For the simulator,
+                                    // it is the PC clock time corresponding to the virtual time.
+    qint64 receivedTimeUs;          // when the sample was received, in PC clock (see pcClockUs())
+    qint64 transferTimeUs;          // minimum time it takes to transfer the sample to PC. 0 if not sent over a wire.
+    double angleInDegrees;
+    int position;                   // in units of the source (1 / positionsPerRevolution of a revolution)
+};
+
+/*
+ * How the vector moves, as reported by the arduino SW.
+ */
+struct MotionProfile
+{
+    double accelerationDegPerSec2;  // used for starts, stops, speed changes and reversals
+    int positionsPerRevolution;     // resolution of the reported position. 0 if not reported.
+};
+
+/*************************************************************************************************
+ Interface of whatever consumes the vector position.  All sample sources push typed samples into
+ a sink; only the physical serial link carries the position as text.
+ *************************************************************************************************/
+class SampleSink
+{
+public:
+    virtual ~SampleSink() {}
+    virtual void pushSample(const AngleSample &sample) = 0;
+    virtual void setMotionProfile(const MotionProfile &profile) = 0;
+};
+
+/*
+ * Monotonic PC clock in microseconds, shared by all sample sources.
+ */
+qint64 pcClockUs();
+
+#endif // SAMPLESINK_H
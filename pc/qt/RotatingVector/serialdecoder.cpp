@@ -0,0 +1,106 @@
+#include "serialdecoder.h"
+#include <stdio.h>
+
+SerialDecoder::SerialDecoder(SampleSink *sink_) :
+    sink(sink_)
+{
+}
+
+/*
+ * Append received bytes and decode all lines completed by them.
+ */
+void SerialDecoder::feed(const QByteArray &data)
+{
+    qint64 receivedTimeUs = pcClockUs();
+
+    pendingData.append(data);
+
+    int newlineIndex;
+    while ((newlineIndex = pendingData.indexOf('\n')) >= 0)
+    {
+        QByteArray line = pendingData.left(newlineIndex);
+        pendingData.remove(0, newlineIndex + 1);
+
+        AngleSample sample;
+        if (decodeLine(line, receivedTimeUs, sample))
+        {
+            sink->pushSample(sample);
+        }
+        else
+        {
+            printf("Arduino: %s\n", line.trimmed().constData());
+
+            MotionProfile profile;
+            if (decodeProfileLine(line, profile))
+            {
+                positionsPerRevolution = profile.positionsPerRevolution;
+                sink->setMotionProfile(profile);
+            }
+        }
+    }
+}
+
+/*
+ * Discard partially received line.
+ */
+void SerialDecoder::reset()
+{
+    pendingData.clear();
+}
+
+/*
+ * Extract angle, position and arduino time from a position line.  Returns false if the line is not a position line.
+ */
+bool SerialDecoder::decodeLine(const QByteArray &line, qint64 receivedTimeUs, AngleSample &sample)
+{
+    QRegularExpressionMatch match = positionRe.match(QString::fromLatin1(line));
+
+    if (!match.hasMatch())
+        return false;
+
+    sample.position = match.captured(2).toInt();
+
+    // printed angle is rounded. calculate it from position when its resolution is known.
+    if (positionsPerRevolution > 0)
+        sample.angleInDegrees = sample.position * 360.0 / positionsPerRevolution;
+    else
+        sample.angleInDegrees = match.captured(1).toDouble();
+    sample.receivedTimeUs = receivedTimeUs;
+
+    // bytes in the line including the new line, at the serial baud rate
+    sample.transferTimeUs = qint64(line.size() + 1) * SERIAL_BITS_PER_BYTE * 1000000 / SERIAL_BAUD_RATE;
+
+    if (match.capturedLength(3) > 0)
+    {
+        quint32 deviceTimeUs = quint32(match.captured(3).toULong());
+        if (deviceTimeUs < lastDeviceTimeUs)
+            deviceTimeWrapUs += qint64(1) << 32;
+        lastDeviceTimeUs = deviceTimeUs;
+
+        sample.timestampUs = deviceTimeWrapUs + deviceTimeUs;
+    }
+    else
+    {
+        // older arduino SW doesn't send its time. Receipt time is the best we know.
+        sample.timestampUs = receivedTimeUs - sample.transferTimeUs;
+    }
+    return true;
+}
+
+/*
+ * "profile <acceleration in degrees/s^2> [<positions per revolution>]", printed by arduino SW at startup and
+ * for the 'm' command.
+ */
+bool SerialDecoder::decodeProfileLine(const QByteArray &line, MotionProfile &profile)
+{
+    static const QRegularExpression profileRe("^\\s*profile[ ]+(\\d+(?:\\.\\d+)?)(?:[ ]+(\\d+))?\\s*$");
+
+    QRegularExpressionMatch match = profileRe.match(QString::fromLatin1(line));
+
+    if (!match.hasMatch())
+        return false;
+
+    profile.accelerationDegPerSec2 = match.captured(1).toDouble();
+    profile.positionsPerRevolution = match.captured(2).toInt();     // 0 if absent
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef SERIALDECODER_H
+#define SERIALDECODER_H
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include "samplesink.h"
+
+#define SERIAL_BAUD_RATE            115200
+#define SERIAL_BITS_PER_BYTE        10          // 8 data bits, 1 start bit and 1 stop bit
+
+/*************************************************************************************************
+ Decodes the text received from arduino over the serial port.  Every complete line that reports
+ position is pushed to the sink as a typed sample, and the motion profile is handed to the sink.
+ Other lines are messages from the arduino SW and are only printed.
+ *************************************************************************************************/
+class SerialDecoder
+{
+public:
+    SerialDecoder(SampleSink *sink_);
+    void feed(const QByteArray &data);
+    void reset();
+    bool decodeLine(const QByteArray &line, qint64 receivedTimeUs, AngleSample &sample);
+    static bool decodeProfileLine(const QByteArray &line, MotionProfile &profile);
+
+private:
+    SampleSink *sink;
+    QByteArray pendingData;             // received bytes not yet terminated by a new line
+    qint64 deviceTimeWrapUs = 0;        // arduino's micros() wraps around every ~71 minutes
+    quint32 lastDeviceTimeUs = 0;
+
+    int positionsPerRevolution = 0;     // from motion profile. 0 until received.
+
+    // "<angle> <position> [<arduino time in us>]"
+    QRegularExpression positionRe = QRegularExpression("^\\s*(\\d+\\.\\d+)[ ]+(\\d+)(?:[ ]+(\\d+))?\\s*$");
+};
+
+#endif // SERIALDECODER_H
@@ -0,0 +1,189 @@
+#include "trigkernel.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TRIG_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define TRIG_KERNEL_AVX2
+#include <immintrin.h>
+#endif
+
+#define TRIG_TABLE_STEP_DEGREES         (360.0 / TRIG_TABLE_SIZE)
+
+// Minimax polynomials for sin and cos over [-45, 45] degrees (in radians), good to float precision.
+#define SIN_C1      -1.6666654611e-1f
+#define SIN_C2       8.3321608736e-3f
+#define SIN_C3      -1.9515295891e-4f
+#define COS_C1       4.166664568298827e-2f
+#define COS_C2      -1.388731625493765e-3f
+#define COS_C3       2.443315711809948e-5f
+#define DEG_TO_RAD_F 0.017453292519943295f
+
+
+/*
+ * Sine of the half step angles. 0, +-0.5 and +-1 are made exact; sin() is a hair off at some of them.
+ */
+struct SinTable
+{
+    double values[TRIG_TABLE_SIZE];
+
+    SinTable()
+    {
+        for (int i=0; i<TRIG_TABLE_SIZE; i++)
+        {
+            double value = sin(i * (2 * M_PI / TRIG_TABLE_SIZE));
+            double roundedToHalf = round(value * 2) / 2;
+
+            values[i] = (fabs(value - roundedToHalf) < 1e-12) ? roundedToHalf + 0.0 : value;     // + 0.0 turns -0 into 0
+        }
+    }
+};
+
+static const SinTable sinTable;
+
+/*
+ * Index in the table if angle is a half step angle, -1 otherwise.
+ */
+static int getTableIndex(double angleInDegrees)
+{
+    double index = angleInDegrees / TRIG_TABLE_STEP_DEGREES;
+    double roundedIndex = floor(index + 0.5);
+
+    if (fabs(index - roundedIndex) > 1e-9)
+        return -1;
+
+    int tableIndex = int(fmod(roundedIndex, TRIG_TABLE_SIZE));
+    return (tableIndex < 0) ? tableIndex + TRIG_TABLE_SIZE : tableIndex;
+}
+
+double sinDegrees(double angleInDegrees)
+{
+    int index = getTableIndex(angleInDegrees);
+
+    if (index < 0)
+        return sin(angleInDegrees * M_PI / 180.0);
+
+    return sinTable.values[index];
+}
+
+double cosDegrees(double angleInDegrees)
+{
+    int index = getTableIndex(angleInDegrees);
+
+    if (index < 0)
+        return cos(angleInDegrees * M_PI / 180.0);
+
+    return sinTable.values[(index + TRIG_TABLE_SIZE / 4) % TRIG_TABLE_SIZE];        // cos(a) = sin(a + 90)
+}
+
+/*************************************************************************************************
+ Batch kernel.  Angle is reduced to a number of quarter turns (k) and a remainder (r) within +-45
+ degrees.  sin(angle) is then sin(r), cos(r), -sin(r) or -cos(r) depending on k.
+ *************************************************************************************************/
+static inline int calculateSinOrdinate(float angleInDegrees, float amplitude)
+{
+    int k = int(floorf(angleInDegrees * (1.0f / 90.0f) + 0.5f));
+    float r = (angleInDegrees - float(k) * 90.0f) * DEG_TO_RAD_F;
+    float r2 = r * r;
+
+    float s = r + r * r2 * (SIN_C1 + r2 * (SIN_C2 + r2 * SIN_C3));
+    float c = 1.0f - 0.5f * r2 + r2 * r2 * (COS_C1 + r2 * (COS_C2 + r2 * COS_C3));
+
+    float value = (k & 1) ? c : s;
+    if (k & 2)
+        value = -value;
+
+    return int(amplitude * value);
+}
+
+#ifdef TRIG_KERNEL_AVX2
+/*
+ * 8 angles at a time. Returns index of the first angle not calculated.
+ */
+static int calculateSinOrdinatesAvx2(const float *angles, int i, int count, float phase, float amplitude, int *ordinates)
+{
+    const __m256 vPhase     = _mm256_set1_ps(phase);
+    const __m256 vAmplitude = _mm256_set1_ps(amplitude);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256  a  = _mm256_add_ps(_mm256_loadu_ps(angles + i), vPhase);
+        __m256i k  = _mm256_cvtps_epi32(_mm256_mul_ps(a, _mm256_set1_ps(1.0f / 90.0f)));
+        __m256  r  = _mm256_mul_ps(_mm256_sub_ps(a, _mm256_mul_ps(_mm256_cvtepi32_ps(k), _mm256_set1_ps(90.0f))),
+                                   _mm256_set1_ps(DEG_TO_RAD_F));
+        __m256  r2 = _mm256_mul_ps(r, r);
+
+        __m256 s = _mm256_add_ps(_mm256_set1_ps(SIN_C2), _mm256_mul_ps(r2, _mm256_set1_ps(SIN_C3)));
+        s = _mm256_add_ps(_mm256_set1_ps(SIN_C1), _mm256_mul_ps(r2, s));
+        s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), s));
+
+        __m256 c = _mm256_add_ps(_mm256_set1_ps(COS_C2), _mm256_mul_ps(r2, _mm256_set1_ps(COS_C3)));
+        c = _mm256_add_ps(_mm256_set1_ps(COS_C1), _mm256_mul_ps(r2, c));
+        c = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), r2)),
+                          _mm256_mul_ps(_mm256_mul_ps(r2, r2), c));
+
+        __m256i one    = _mm256_set1_epi32(1);
+        __m256  useCos = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(k, one), one));
+        __m256  sign   = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(k, _mm256_set1_epi32(2)), 30));
+        __m256  value  = _mm256_xor_ps(_mm256_blendv_ps(s, c, useCos), sign);
+
+        _mm256_storeu_si256((__m256i *)(ordinates + i), _mm256_cvttps_epi32(_mm256_mul_ps(value, vAmplitude)));
+    }
+    return i;
+}
+#endif
+
+#ifdef TRIG_KERNEL_SSE2
+/*
+ * 4 angles at a time. Returns index of the first angle not calculated.
+ */
+static int calculateSinOrdinatesSse2(const float *angles, int i, int count, float phase, float amplitude, int *ordinates)
+{
+    const __m128 vPhase     = _mm_set1_ps(phase);
+    const __m128 vAmplitude = _mm_set1_ps(amplitude);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128  a  = _mm_add_ps(_mm_loadu_ps(angles + i), vPhase);
+        __m128i k  = _mm_cvtps_epi32(_mm_mul_ps(a, _mm_set1_ps(1.0f / 90.0f)));
+        __m128  r  = _mm_mul_ps(_mm_sub_ps(a, _mm_mul_ps(_mm_cvtepi32_ps(k), _mm_set1_ps(90.0f))),
+                                _mm_set1_ps(DEG_TO_RAD_F));
+        __m128  r2 = _mm_mul_ps(r, r);
+
+        __m128 s = _mm_add_ps(_mm_set1_ps(SIN_C2), _mm_mul_ps(r2, _mm_set1_ps(SIN_C3)));
+        s = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(r2, s));
+        s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+        __m128 c = _mm_add_ps(_mm_set1_ps(COS_C2), _mm_mul_ps(r2, _mm_set1_ps(COS_C3)));
+        c = _mm_add_ps(_mm_set1_ps(COS_C1), _mm_mul_ps(r2, c));
+        c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+                       _mm_mul_ps(_mm_mul_ps(r2, r2), c));
+
+        __m128i one    = _mm_set1_epi32(1);
+        __m128  useCos = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(k, one), one));
+        __m128  sign   = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(k, _mm_set1_epi32(2)), 30));
+        __m128  value  = _mm_xor_ps(_mm_or_ps(_mm_and_ps(useCos, c), _mm_andnot_ps(useCos, s)), sign);
+
+        _mm_storeu_si128((__m128i *)(ordinates + i), _mm_cvttps_epi32(_mm_mul_ps(value, vAmplitude)));
+    }
+    return i;
+}
+#endif
+
+void calculateSinOrdinates(const float *anglesInDegrees, int count, float phaseInDegrees, float amplitude, int *ordinates)
+{
+    int i = 0;
+
+#ifdef TRIG_KERNEL_AVX2
+    i = calculateSinOrdinatesAvx2(anglesInDegrees, i, count, phaseInDegrees, amplitude, ordinates);
+#endif
+#ifdef TRIG_KERNEL_SSE2
+    i = calculateSinOrdinatesSse2(anglesInDegrees, i, count, phaseInDegrees, amplitude, ordinates);
+#endif
+
+    for (; i<count; i++)
+        ordinates[i] = calculateSinOrdinate(anglesInDegrees[i] + phaseInDegrees, amplitude);
+}
@@ -0,0 +1,22 @@
+#ifndef TRIGKERNEL_H
+#define TRIGKERNEL_H
+
+#define TRIG_TABLE_SIZE                 400         // half steps of the motor in a revolution (0.9 degrees each)
+
+/*************************************************************************************************
+ Sine and cosine of angles in degrees.
+
+ Scalar versions look up a table for the angles the motor can stop at in half steps, where they
+ are exact (e.g. sin(90) is 1, cos(90) is 0).  Other angles go to the math library.
+
+ Batch version is for the hot path, turning a whole history of angles into ordinates at once. It
+ uses SSE2 (or AVX2, when compiled for it) with a polynomial accurate to float precision, and the
+ same polynomial in plain C++ on other CPUs.
+ *************************************************************************************************/
+double sinDegrees(double angleInDegrees);
+double cosDegrees(double angleInDegrees);
+
+// ordinates[i] = int(amplitude * sin(anglesInDegrees[i] + phaseInDegrees)), like a cast of the exact value.
+void calculateSinOrdinates(const float *anglesInDegrees, int count, float phaseInDegrees, float amplitude, int *ordinates);
+
+#endif // TRIGKERNEL_H
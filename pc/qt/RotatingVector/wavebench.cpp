@@ -0,0 +1,73 @@
+#include "wavebench.h"
+#include "projectionset.h"
+#include "samplesink.h"
+#include <QImage>
+#include <QPainter>
+#include <math.h>
+#include <stdio.h>
+
+#define WAVE_BENCH_AMPLITUDE            150
+#define WAVE_BENCH_PEN_WIDTH            12
+#define WAVE_BENCH_DEGREES_PER_SAMPLE   1.8         // 13 rpm at 60 frames per second is about 5 degrees a frame
+
+
+/*
+ * Average time to draw one wave, in us.
+ */
+qint64 WaveBench::run(Backend backend, bool isVertical)
+{
+    QImage image(WAVE_BENCH_WIDTH, WAVE_BENCH_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+
+    //----------------------------------------------------------------
+    // Vector at bottom right as in the render widget, with a full history of a steadily rotating vector.
+    //----------------------------------------------------------------
+    ProjectionSet projections(int(ceil(hypot(WAVE_BENCH_WIDTH, WAVE_BENCH_HEIGHT))) + 2);
+    Projection *projection = projections.add(isVertical ? 90 : 0, "", QColor(120, 220, 120));
+
+    projections.recalculatePosition(WAVE_BENCH_WIDTH - WAVE_BENCH_AMPLITUDE - 135, WAVE_BENCH_HEIGHT - WAVE_BENCH_AMPLITUDE - 135,
+                                    WAVE_BENCH_AMPLITUDE, 30);
+    projections.setWaveRasterizer(backend == WAVE_RASTERIZER);
+
+    for (int i=0; i<projections.history.maxSamples; i++)
+        projections.addSample(fmod(i * WAVE_BENCH_DEGREES_PER_SAMPLE, 360), true, false);
+
+    //----------------------------------------------------------------
+    // One untimed frame to allocate buffers, then the timed ones. The wave moves on a sample every frame.
+    //----------------------------------------------------------------
+    qint64 totalUs = 0;
+
+    for (int frame=-1; frame<WAVE_BENCH_FRAMES; frame++)
+    {
+        image.fill(Qt::black);
+        projections.addSample(fmod((projections.history.maxSamples + frame) * WAVE_BENCH_DEGREES_PER_SAMPLE, 360), true, false);
+
+        QPainter p(&image);
+        p.setRenderHint(QPainter::Antialiasing, backend == PAINTER_ANTIALIASED);
+
+        qint64 startUs = pcClockUs();
+        projection->drawWave(&p, 1, WAVE_BENCH_PEN_WIDTH);
+        qint64 endUs = pcClockUs();
+
+        if (frame >= 0)
+            totalUs += endUs - startUs;
+    }
+    return totalUs / WAVE_BENCH_FRAMES;
+}
+
+/*
+ * Run all backends on both orientations. Returns 0, as there are no limits to check.
+ */
+int WaveBench::runAll()
+{
+    const char *backendNames[NUM_BACKENDS] = { "QPainter, aliased", "QPainter, antialiased", "WaveRasterizer" };
+
+    printf("Wave bench: %dx%d, pen width %d, average of %d frames\n", WAVE_BENCH_WIDTH, WAVE_BENCH_HEIGHT,
+           WAVE_BENCH_PEN_WIDTH, WAVE_BENCH_FRAMES);
+
+    for (int backend=0; backend<NUM_BACKENDS; backend++)
+    {
+        printf("    %-28s horizontal %6lld us    vertical %6lld us\n", backendNames[backend],
+               (long long)run(Backend(backend), false), (long long)run(Backend(backend), true));
+    }
+    return 0;
+}
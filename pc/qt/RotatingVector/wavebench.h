@@ -0,0 +1,27 @@
+#ifndef WAVEBENCH_H
+#define WAVEBENCH_H
+
+#include <QtGlobal>
+
+#define WAVE_BENCH_WIDTH                1600
+#define WAVE_BENCH_HEIGHT               900
+#define WAVE_BENCH_FRAMES               200
+
+
+/*************************************************************************************************
+ Times drawing a screenful of sine (horizontal) and cosine (vertical) waves into an image, with
+ QPainter's stroker (aliased as the render widget draws it, and antialiased) and with WaveRasterizer.
+ Run with --wave-bench; results are printed.
+ *************************************************************************************************/
+class WaveBench
+{
+public:
+    int runAll();
+
+private:
+    enum Backend { PAINTER_ALIASED, PAINTER_ANTIALIASED, WAVE_RASTERIZER, NUM_BACKENDS };
+
+    qint64 run(Backend backend, bool isVertical);
+};
+
+#endif // WAVEBENCH_H
@@ -0,0 +1,336 @@
+#include "waverasterizer.h"
+#include "paintdevice.h"
+#include <algorithm>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define WAVE_RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+#define NO_SPAN                 1e30f       // span start (and minus span end) of a subcolumn the wave doesn't cross
+#define MIN_SEGMENT_SLOPE       1e-3f       // flatter segments are taken as this steep, to keep the math branch free
+#define SUBCOLUMN_OFFSET(s)     ((float(s) + 0.5f) / WAVE_SUBCOLUMNS)      // where in a column a subcolumn is sampled
+
+#if defined(WAVE_RASTERIZER_SSE2) && (WAVE_SUBCOLUMNS != 4)
+#error SSE2 version handles 4 subcolumns, one per lane
+#endif
+
+
+void WaveRasterizer::draw(QPainter *p, const QPoint *vertices, int numVertices, bool isVertical, int center, int extent,
+                          int penWidth, QColor color, double opacity)
+{
+    if (numVertices <= 0)
+        return;
+
+    qreal pixelRatio = p->device()->devicePixelRatioF();
+    float radius = float(penWidth * pixelRatio / 2);
+
+    //----------------------------------------------------------------
+    // Image covers the wave between its end vertices, inside the widget. u runs along the wave, v across it.
+    //----------------------------------------------------------------
+    int uFirst = isVertical ? vertices[0].y() : vertices[0].x();
+    int uLast  = isVertical ? vertices[numVertices-1].y() : vertices[numVertices-1].x();
+
+    int uMin = int(floor(std::min(uFirst, uLast) * pixelRatio - radius));
+    int uMax = int(ceil (std::max(uFirst, uLast) * pixelRatio + radius));
+    int vMin = int(floor((center - extent) * pixelRatio - radius));
+    int vMax = int(ceil ((center + extent) * pixelRatio + radius));
+
+    QRect bounds = isVertical ? QRect(QPoint(vMin, uMin), QPoint(vMax, uMax)) : QRect(QPoint(uMin, vMin), QPoint(uMax, vMax));
+    QSizeF deviceSize = getLogicalSize(p->device()) * pixelRatio;
+    bounds &= QRect(0, 0, int(ceil(deviceSize.width())), int(ceil(deviceSize.height())));
+    if (bounds.isEmpty())
+        return;
+
+    prepareImage(bounds, isVertical, pixelRatio);
+
+    //----------------------------------------------------------------
+    // Vertices relative to the image, in the order of increasing u.
+    //----------------------------------------------------------------
+    int uOrigin = isVertical ? bounds.y() : bounds.x();
+    int vOrigin = isVertical ? bounds.x() : bounds.y();
+    bool isReversed = uLast < uFirst;
+
+    u.resize(size_t(numVertices));
+    v.resize(size_t(numVertices));
+    for (int i=0; i<numVertices; i++)
+    {
+        const QPoint &vertex = vertices[isReversed ? numVertices - 1 - i : i];
+
+        u[size_t(i)] = float((isVertical ? vertex.y() : vertex.x()) * pixelRatio - uOrigin);
+        v[size_t(i)] = float((isVertical ? vertex.x() : vertex.y()) * pixelRatio - vOrigin);
+    }
+
+    //----------------------------------------------------------------
+    // Spans, then pixels.
+    //----------------------------------------------------------------
+    std::fill(spanFrom.begin(), spanFrom.end(), NO_SPAN);
+    std::fill(spanTo.begin(), spanTo.end(), -NO_SPAN);
+
+    for (int i=0; i<numVertices-1; i++)
+    {
+        addDisc(u[size_t(i)], v[size_t(i)], radius);
+        addBand(u[size_t(i)], v[size_t(i)], u[size_t(i+1)], v[size_t(i+1)], radius);
+    }
+    addDisc(u[size_t(numVertices-1)], v[size_t(numVertices-1)], radius);
+
+    writeColumns(color, opacity);
+
+    // opacity is in the image already.
+    qreal painterOpacity = p->opacity();
+    p->setOpacity(1);
+    p->drawImage(QPointF(bounds.x() / pixelRatio, bounds.y() / pixelRatio), image);
+    p->setOpacity(painterOpacity);
+}
+
+/*
+ * Image (and buffers) for the given bounds. Kept from the previous frame if bounds haven't changed.
+ */
+void WaveRasterizer::prepareImage(QRect deviceBounds, bool isVertical, qreal pixelRatio)
+{
+    if ((deviceBounds == imageBounds) && (isVertical == isImageVertical) && (pixelRatio == imagePixelRatio))
+        return;
+
+    image = QImage(deviceBounds.size(), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(pixelRatio);
+    image.fill(Qt::transparent);
+
+    imageBounds = deviceBounds;
+    isImageVertical = isVertical;
+    imagePixelRatio = pixelRatio;
+
+    numColumns = isVertical ? deviceBounds.height() : deviceBounds.width();
+    numRows    = isVertical ? deviceBounds.width()  : deviceBounds.height();
+
+    spanFrom.resize(size_t(numColumns) * WAVE_SUBCOLUMNS);
+    spanTo.resize(size_t(numColumns) * WAVE_SUBCOLUMNS);
+    writtenFrom.assign(size_t(numColumns), 0);
+    writtenTo.assign(size_t(numColumns), 0);
+}
+
+/*
+ * Round cap / join at a vertex: extends spans of the columns within radius to the disc.
+ */
+void WaveRasterizer::addDisc(float u0, float v0, float radius)
+{
+    int firstColumn = std::max(0, int(floorf(u0 - radius)));
+    int lastColumn  = std::min(numColumns - 1, int(floorf(u0 + radius)));
+
+#ifdef WAVE_RASTERIZER_SSE2
+    const __m128 offsets  = _mm_setr_ps(SUBCOLUMN_OFFSET(0), SUBCOLUMN_OFFSET(1), SUBCOLUMN_OFFSET(2), SUBCOLUMN_OFFSET(3));
+    const __m128 radius2  = _mm_set1_ps(radius * radius);
+    const __m128 center   = _mm_set1_ps(v0);
+    const __m128 zero     = _mm_setzero_ps();
+    const __m128 noFrom   = _mm_set1_ps(NO_SPAN);
+    const __m128 noTo     = _mm_set1_ps(-NO_SPAN);
+
+    for (int c=firstColumn; c<=lastColumn; c++)
+    {
+        __m128 du     = _mm_add_ps(_mm_set1_ps(float(c) - u0), offsets);
+        __m128 half2  = _mm_sub_ps(radius2, _mm_mul_ps(du, du));
+        __m128 inside = _mm_cmpge_ps(half2, zero);
+        __m128 half   = _mm_sqrt_ps(_mm_max_ps(half2, zero));
+
+        __m128 from = _mm_or_ps(_mm_and_ps(inside, _mm_sub_ps(center, half)), _mm_andnot_ps(inside, noFrom));
+        __m128 to   = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(center, half)), _mm_andnot_ps(inside, noTo));
+
+        float *pFrom = &spanFrom[size_t(c) * WAVE_SUBCOLUMNS];
+        float *pTo   = &spanTo[size_t(c) * WAVE_SUBCOLUMNS];
+        _mm_storeu_ps(pFrom, _mm_min_ps(_mm_loadu_ps(pFrom), from));
+        _mm_storeu_ps(pTo,   _mm_max_ps(_mm_loadu_ps(pTo), to));
+    }
+#else
+    for (int c=firstColumn; c<=lastColumn; c++)
+    {
+        for (int s=0; s<WAVE_SUBCOLUMNS; s++)
+        {
+            float du = float(c) - u0 + SUBCOLUMN_OFFSET(s);
+            float half2 = radius * radius - du * du;
+
+            if (half2 >= 0)
+            {
+                float half = sqrtf(half2);
+                size_t i = size_t(c) * WAVE_SUBCOLUMNS + size_t(s);
+
+                spanFrom[i] = std::min(spanFrom[i], v0 - half);
+                spanTo[i]   = std::max(spanTo[i], v0 + half);
+            }
+        }
+    }
+#endif
+}
+
+/*
+ * Body of a segment (u1 > u0): points within radius of the line whose projection falls on the segment.
+ * Across a column, these are between two parallel lines (distance to the line) and between two lines
+ * perpendicular to the segment at its ends.  Span is the overlap of the two intervals, relative to v0.
+ */
+void WaveRasterizer::addBand(float u0, float v0, float u1, float v1, float radius)
+{
+    float du = u1 - u0;
+    float dv = v1 - v0;
+
+    if (du <= 0)
+        return;
+
+    float length2 = du * du + dv * dv;
+    float length = sqrtf(length2);
+    float slope = dv / du;
+    float halfHeight = radius * length / du;
+
+    float dvNonZero = (fabsf(dv) >= MIN_SEGMENT_SLOPE) ? dv : ((dv < 0) ? -MIN_SEGMENT_SLOPE : MIN_SEGMENT_SLOPE);
+    float endSlope = -du / dvNonZero;
+    float endDistance = length2 / dvNonZero;
+
+    // ends of the band stick out of the segment by as much as they are slanted
+    float overhang = radius * fabsf(dv) / length;
+    int firstColumn = std::max(0, int(floorf(u0 - overhang)));
+    int lastColumn  = std::min(numColumns - 1, int(floorf(u1 + overhang)));
+
+#ifdef WAVE_RASTERIZER_SSE2
+    const __m128 offsets    = _mm_setr_ps(SUBCOLUMN_OFFSET(0), SUBCOLUMN_OFFSET(1), SUBCOLUMN_OFFSET(2), SUBCOLUMN_OFFSET(3));
+    const __m128 vSlope     = _mm_set1_ps(slope);
+    const __m128 vHalf      = _mm_set1_ps(halfHeight);
+    const __m128 vEndSlope  = _mm_set1_ps(endSlope);
+    const __m128 vEndDist   = _mm_set1_ps(endDistance);
+    const __m128 vOrigin    = _mm_set1_ps(v0);
+    const __m128 noFrom     = _mm_set1_ps(NO_SPAN);
+    const __m128 noTo       = _mm_set1_ps(-NO_SPAN);
+
+    for (int c=firstColumn; c<=lastColumn; c++)
+    {
+        __m128 a      = _mm_add_ps(_mm_set1_ps(float(c) - u0), offsets);
+        __m128 middle = _mm_mul_ps(a, vSlope);
+        __m128 end0   = _mm_mul_ps(a, vEndSlope);
+        __m128 end1   = _mm_add_ps(end0, vEndDist);
+
+        __m128 from   = _mm_max_ps(_mm_sub_ps(middle, vHalf), _mm_min_ps(end0, end1));
+        __m128 to     = _mm_min_ps(_mm_add_ps(middle, vHalf), _mm_max_ps(end0, end1));
+        __m128 inside = _mm_cmple_ps(from, to);
+
+        from = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(vOrigin, from)), _mm_andnot_ps(inside, noFrom));
+        to   = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(vOrigin, to)),   _mm_andnot_ps(inside, noTo));
+
+        float *pFrom = &spanFrom[size_t(c) * WAVE_SUBCOLUMNS];
+        float *pTo   = &spanTo[size_t(c) * WAVE_SUBCOLUMNS];
+        _mm_storeu_ps(pFrom, _mm_min_ps(_mm_loadu_ps(pFrom), from));
+        _mm_storeu_ps(pTo,   _mm_max_ps(_mm_loadu_ps(pTo), to));
+    }
+#else
+    for (int c=firstColumn; c<=lastColumn; c++)
+    {
+        for (int s=0; s<WAVE_SUBCOLUMNS; s++)
+        {
+            float a = float(c) - u0 + SUBCOLUMN_OFFSET(s);
+            float middle = a * slope;
+            float end0 = a * endSlope;
+            float end1 = end0 + endDistance;
+
+            float from = std::max(middle - halfHeight, std::min(end0, end1));
+            float to   = std::min(middle + halfHeight, std::max(end0, end1));
+
+            if (from <= to)
+            {
+                size_t i = size_t(c) * WAVE_SUBCOLUMNS + size_t(s);
+
+                spanFrom[i] = std::min(spanFrom[i], v0 + from);
+                spanTo[i]   = std::max(spanTo[i], v0 + to);
+            }
+        }
+    }
+#endif
+}
+
+/*
+ * Pixel of a row from the spans of its column. Coverage is the average length of the subcolumn spans inside
+ * the pixel; 'channels' are the premultiplied color (blue, green, red, alpha) divided by number of subcolumns.
+ */
+static inline quint32 getPixel(const float *from, const float *to, int row, const float *channels)
+{
+#ifdef WAVE_RASTERIZER_SSE2
+    const __m128 one  = _mm_set1_ps(1);
+    const __m128 top  = _mm_set1_ps(float(row));
+
+    __m128 coverage = _mm_sub_ps(_mm_min_ps(_mm_add_ps(top, one), _mm_loadu_ps(to)), _mm_max_ps(top, _mm_loadu_ps(from)));
+    coverage = _mm_min_ps(_mm_max_ps(coverage, _mm_setzero_ps()), one);
+
+    // sum of the subcolumns in every lane
+    coverage = _mm_add_ps(coverage, _mm_shuffle_ps(coverage, coverage, _MM_SHUFFLE(1, 0, 3, 2)));
+    coverage = _mm_add_ps(coverage, _mm_shuffle_ps(coverage, coverage, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    __m128i pixel = _mm_cvtps_epi32(_mm_mul_ps(coverage, _mm_loadu_ps(channels)));
+    pixel = _mm_packs_epi32(pixel, pixel);
+    pixel = _mm_packus_epi16(pixel, pixel);
+    return quint32(_mm_cvtsi128_si32(pixel));
+#else
+    float coverage = 0;
+    for (int s=0; s<WAVE_SUBCOLUMNS; s++)
+        coverage += std::min(std::max(std::min(float(row + 1), to[s]) - std::max(float(row), from[s]), 0.0f), 1.0f);
+
+    return (quint32(channels[3] * coverage + 0.5f) << 24) |
+           (quint32(channels[2] * coverage + 0.5f) << 16) |
+           (quint32(channels[1] * coverage + 0.5f) << 8)  |
+            quint32(channels[0] * coverage + 0.5f);
+#endif
+}
+
+/*
+ * Pixels of every column from its spans. Rows inside all the subcolumn spans are fully covered and only
+ * need the color. Pixels written by the previous frame and not by this one are cleared.
+ */
+void WaveRasterizer::writeColumns(QColor color, double opacity)
+{
+    float alpha = float(color.alphaF() * opacity);
+    float channels[4] = { float(color.blueF())  * alpha * 255 / WAVE_SUBCOLUMNS,
+                          float(color.greenF()) * alpha * 255 / WAVE_SUBCOLUMNS,
+                          float(color.redF())   * alpha * 255 / WAVE_SUBCOLUMNS,
+                          alpha * 255 / WAVE_SUBCOLUMNS };
+
+    quint32 *pixels = reinterpret_cast<quint32 *>(image.bits());
+    int stride = image.bytesPerLine() / 4;
+    int columnStep = isImageVertical ? stride : 1;
+    int rowStep    = isImageVertical ? 1 : stride;
+
+    float solidSpan[2 * WAVE_SUBCOLUMNS];
+    std::fill(solidSpan, solidSpan + WAVE_SUBCOLUMNS, 0.0f);
+    std::fill(solidSpan + WAVE_SUBCOLUMNS, solidSpan + 2 * WAVE_SUBCOLUMNS, 1.0f);
+    quint32 solidPixel = getPixel(solidSpan, solidSpan + WAVE_SUBCOLUMNS, 0, channels);
+
+    for (int c=0; c<numColumns; c++)
+    {
+        const float *from = &spanFrom[size_t(c) * WAVE_SUBCOLUMNS];
+        const float *to   = &spanTo[size_t(c) * WAVE_SUBCOLUMNS];
+        quint32 *column = pixels + c * columnStep;
+
+        float minFrom = *std::min_element(from, from + WAVE_SUBCOLUMNS);
+        float maxTo   = *std::max_element(to, to + WAVE_SUBCOLUMNS);
+
+        int rowFrom = 0, rowTo = 0;
+        if (minFrom < maxTo)
+        {
+            rowFrom = std::max(0, int(floorf(minFrom)));
+            rowTo   = std::min(numRows, int(ceilf(maxTo)));
+        }
+
+        // rows of the previous frame outside this frame's
+        for (int r=writtenFrom[size_t(c)]; r<std::min(writtenTo[size_t(c)], rowFrom); r++)
+            column[r * rowStep] = 0;
+        for (int r=std::max(writtenFrom[size_t(c)], rowTo); r<writtenTo[size_t(c)]; r++)
+            column[r * rowStep] = 0;
+
+        writtenFrom[size_t(c)] = rowFrom;
+        writtenTo[size_t(c)] = rowTo;
+
+        // antialiased edges around a solid middle (which may be empty)
+        int solidFrom = std::min(std::max(rowFrom, int(ceilf(*std::max_element(from, from + WAVE_SUBCOLUMNS)))), rowTo);
+        int solidTo   = std::max(std::min(rowTo, int(floorf(*std::min_element(to, to + WAVE_SUBCOLUMNS)))), solidFrom);
+
+        for (int r=rowFrom; r<solidFrom; r++)
+            column[r * rowStep] = getPixel(from, to, r, channels);
+        for (int r=solidFrom; r<solidTo; r++)
+            column[r * rowStep] = solidPixel;
+        for (int r=solidTo; r<rowTo; r++)
+            column[r * rowStep] = getPixel(from, to, r, channels);
+    }
+}
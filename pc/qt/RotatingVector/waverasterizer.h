@@ -0,0 +1,55 @@
+#ifndef WAVERASTERIZER_H
+#define WAVERASTERIZER_H
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPoint>
+#include <vector>
+
+#define WAVE_SUBCOLUMNS                 4           // coverage samples across a pixel column
+
+
+/*************************************************************************************************
+ Draws a wave, a thick polyline with round caps and joins that is monotonic along one device axis,
+ without going through QPainter's general stroker.
+
+ Wave is rasterized column by column (a column runs across the wave). The part of the thick line
+ crossing a column is a single span, the union of the discs at the vertices and of the bands along
+ the segments, which are simple to intersect with a vertical line.  Spans are found at a few points
+ across each column, and a pixel is covered by the part of those spans it contains (antialiasing).
+ SSE2 handles the subcolumns of a column at once; other CPUs use the same math in plain C++.
+
+ Spans are written straight into a premultiplied ARGB32 image covering the wave, which is then drawn
+ in one call.  Only the pixels written by the previous frame are cleared.
+ *************************************************************************************************/
+class WaveRasterizer
+{
+public:
+    // Vertices are in widget coordinates with painter untransformed, strictly monotonic along x (or along y if
+    // 'isVertical'). Ordinates stay within 'center' +- 'extent' across the wave.
+    void draw(QPainter *p, const QPoint *vertices, int numVertices, bool isVertical, int center, int extent,
+              int penWidth, QColor color, double opacity);
+
+private:
+    void prepareImage(QRect deviceBounds, bool isVertical, qreal pixelRatio);
+    void addDisc(float u, float v, float radius);
+    void addBand(float u0, float v0, float u1, float v1, float radius);
+    void writeColumns(QColor color, double opacity);
+
+    QImage image;
+    QRect imageBounds;                  // device pixels
+    bool isImageVertical = false;
+    qreal imagePixelRatio = 0;
+    int numColumns = 0;
+    int numRows = 0;
+
+    std::vector<float> u;               // vertices, device pixels relative to the image, u ascending
+    std::vector<float> v;
+    std::vector<float> spanFrom;        // WAVE_SUBCOLUMNS per column
+    std::vector<float> spanTo;
+    std::vector<int> writtenFrom;       // rows written by the previous frame, per column
+    std::vector<int> writtenTo;
+};
+
+#endif // WAVERASTERIZER_H